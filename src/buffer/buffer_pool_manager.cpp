@@ -1,22 +1,76 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <new>
+#include <thread>  // NOLINT
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
+#include "common/util/checksum_util.h"
+#include "fmt/format.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+namespace {
+
+/** Number of entries in a thread's frame cache, a power of two. */
+constexpr size_t FRAME_CACHE_SIZE = 16;
+/** Number of frame cache hits after which a thread records them in the replacer. */
+constexpr size_t FRAME_CACHE_HITS = 64;
+
+/** A thread's recently fetched frames. */
+struct FrameCache {
+  struct Entry {
+    uint64_t instance_id_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    Page *page_{nullptr};
+    uint64_t generation_{0};
+    /** True if the entry was hit since the hits were last recorded in the replacer. */
+    bool hit_{false};
+  };
+
+  /** Direct mapped by page id. */
+  std::array<Entry, FRAME_CACHE_SIZE> entries_;
+  /** Hits since they were last recorded in the replacer. */
+  size_t num_hits_{0};
+};
+
+thread_local FrameCache frame_cache;
+
+auto NextInstanceId() -> uint64_t {
+  static std::atomic<uint64_t> next_instance_id{1};
+  return next_instance_id++;
+}
+
+}  // namespace
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t page_size)
+    : instance_id_(NextInstanceId()),
+      pool_size_(pool_size),
+      page_size_(page_size),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //    "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
   //    "exception line in `buffer_pool_manager.cpp`.");
 
+  BUSTUB_ASSERT((page_size_ & (page_size_ - 1)) == 0 && page_size_ >= 512,
+                "page size should be a power of two and at least 512 bytes");
+
   // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page), std::align_val_t{alignof(Page)}));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(page_size_);
+    pages_[i].pin_count_ = Page::PIN_CLAIMED;
+  }
   replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  frame_swips_.resize(pool_size_, nullptr);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -24,74 +78,96 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_, std::align_val_t{alignof(Page)});
+}
 
 auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  RecordFrameCacheHits();
 
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (bool evict_success = replacer_->Evict(&frame_id); !evict_success) {
-      return nullptr;
-    }
-
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    }
-    page_table_.erase(pages_[frame_id].GetPageId());
+  if (!AcquireFrame(lock, &frame_id)) {
+    return nullptr;
   }
 
   *page_id = AllocatePage();
   page_table_[*page_id] = frame_id;
 
-  pages_[frame_id].pin_count_++;
+  pages_[frame_id].pin_lsn_ = GetLogTail();
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = *page_id;
   pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].pin_count_ = 1;
 
   replacer_->RecordAccess(frame_id);
   replacer_->SetEvictable(frame_id, false);
+  CacheFrame(*page_id, frame_id);
   return &pages_[frame_id];
 }
 
 auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
+  return FetchFrame(page_id, true, nullptr);
+}
 
-  frame_id_t frame_id;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
-    pages_[frame_id].pin_count_++;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    return &pages_[frame_id];
+auto BufferPoolManager::TryFetchPage(page_id_t page_id, TryFetchStatus *status) -> Page * {
+  return FetchFrame(page_id, false, status);
+}
+
+auto BufferPoolManager::FetchFrame(page_id_t page_id, bool wait_for_frame, TryFetchStatus *status) -> Page * {
+  auto set_status = [status](TryFetchStatus value) {
+    if (status != nullptr) {
+      *status = value;
+    }
+  };
+  set_status(TryFetchStatus::Ok);
+  if (Page *page = FetchCachedFrame(page_id); page != nullptr) {
+    return page;
   }
 
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (bool evict_success = replacer_->Evict(&frame_id); !evict_success) {
+  std::unique_lock<std::mutex> lock(latch_);
+  RecordFrameCacheHits();
+
+  frame_id_t frame_id;
+  if (page_table_.find(page_id) == page_table_.end()) {
+    if (!AcquireFrame(lock, &frame_id, wait_for_frame)) {
+      set_status(TryFetchStatus::NoFrame);
       return nullptr;
     }
-
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+    // The latch may have been released while waiting, so another caller could have brought the page in meanwhile.
+    if (page_table_.find(page_id) == page_table_.end()) {
+      if (!ReadFrame(page_id, frame_id)) {
+        pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+        free_list_.push_back(frame_id);
+        NotifyFrameWaiter();
+        if (checksum_policy_ == ChecksumPolicy::Throw) {
+          throw Exception(fmt::format("page {} failed checksum verification", page_id));
+        }
+        set_status(TryFetchStatus::ReadFailed);
+        return nullptr;
+      }
+      page_table_[page_id] = frame_id;
+
+      pages_[frame_id].pin_lsn_ = GetLogTail();
+      pages_[frame_id].page_id_ = page_id;
+      pages_[frame_id].is_dirty_ = false;
+      pages_[frame_id].pin_count_ = 1;
+
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, false);
+      CacheFrame(page_id, frame_id);
+      return &pages_[frame_id];
     }
-    page_table_.erase(pages_[frame_id].GetPageId());
+    free_list_.push_back(frame_id);
+    NotifyFrameWaiter();
   }
 
-  page_table_[page_id] = frame_id;
-  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
+  frame_id = page_table_[page_id];
+  PinFrame(frame_id);
+  CacheFrame(page_id, frame_id);
   return &pages_[frame_id];
 }
 
@@ -102,59 +178,182 @@ auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unus
     return false;
   }
   frame_id_t frame_id = page_table_[page_id];
-  if (pages_[frame_id].GetPinCount() <= 0) {
-    return false;
-  }
-
-  pages_[frame_id].pin_count_--;
-  if (pages_[frame_id].GetPinCount() == 0) {
+  // Other pins may come and go without the latch meanwhile, see TryPinUnlatched() and UnpinFrame().
+  int pin_word = pages_[frame_id].pin_count_.load();
+  int pin_count;
+  do {
+    pin_count = pin_word & ~Page::PIN_EVICTABLE;
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!pages_[frame_id].pin_count_.compare_exchange_weak(pin_word,
+                                                               pin_count == 1 ? Page::PIN_EVICTABLE : pin_word - 1));
+  if (pin_count == 1) {
     replacer_->SetEvictable(frame_id, true);
+    NotifyFrameWaiter();
   }
   if (is_dirty) {
-    pages_[frame_id].is_dirty_ = is_dirty;
+    SetDirty(&pages_[frame_id]);
   }
   return true;
 }
 
-auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+void BufferPoolManager::MarkFrameDirty(Page *page) {
+  if (page->IsDirty()) {
+    return;
+  }
   std::scoped_lock<std::mutex> lock(latch_);
+  SetDirty(page);
+}
 
-  if (page_table_.find(page_id) == page_table_.end()) {
-    return false;
+void BufferPoolManager::SetDirty(Page *page) {
+  if (page->IsDirty()) {
+    return;
   }
+  // The page was changed during the current pin, so no earlier than the log tail when that started.
+  page->is_dirty_ = true;
+  dirty_page_table_.emplace(page->GetPageId(), page->pin_lsn_);
+  dirty_pages_by_rec_lsn_.emplace(page->pin_lsn_, page->GetPageId());
+}
 
-  frame_id_t frame_id = page_table_[page_id];
-  disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;
-  return true;
+auto BufferPoolManager::UnpinFrame(Page *page, bool is_dirty) -> bool {
+  if (!is_dirty) {
+    // Unless this is the last pin of a frame the replacer holds unevictable, the replacer need not hear about it.
+    int pin_word = page->pin_count_.load();
+    while ((pin_word & ~Page::PIN_EVICTABLE) > 1 || pin_word == (Page::PIN_EVICTABLE | 1)) {
+      if (page->pin_count_.compare_exchange_weak(pin_word, pin_word - 1)) {
+        return true;
+      }
+    }
+  }
+  return UnpinPage(page->GetPageId(), is_dirty);
+}
+
+auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  return WriteResidentPage(lock, page_id);
 }
 
 void BufferPoolManager::FlushAllPages() {
-  for (const auto [page_id, _] : page_table_) {
-    FlushPage(page_id);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // Make the log durable for all pages at once, rather than once per page in WriteResidentPage().
+  if (enable_logging && log_manager_ != nullptr) {
+    lsn_t max_lsn = INVALID_LSN;
+    for (const auto [_, frame_id] : page_table_) {
+      if (pages_[frame_id].TryRLatch()) {
+        max_lsn = std::max(max_lsn, pages_[frame_id].GetLSN());
+        pages_[frame_id].RUnlatch();
+      }
+    }
+    FlushLog(lock, max_lsn);
+  }
+  // Write what can be written right away as one batch. WriteResidentPage() may release the latch, so the page table
+  // can change while the rest is written.
+  std::vector<frame_id_t> frame_ids;
+  std::vector<page_id_t> page_ids;
+  for (const auto [page_id, frame_id] : page_table_) {
+    if (pages_[frame_id].TryRLatch()) {
+      if (!LogFlushNeeded(pages_[frame_id].GetLSN())) {
+        frame_ids.push_back(frame_id);
+        continue;
+      }
+      pages_[frame_id].RUnlatch();
+    }
+    page_ids.push_back(page_id);
+  }
+  WriteFrames(frame_ids);
+  for (frame_id_t frame_id : frame_ids) {
+    pages_[frame_id].RUnlatch();
+  }
+  for (page_id_t page_id : page_ids) {
+    WriteResidentPage(lock, page_id);
   }
 }
 
-auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+auto BufferPoolManager::GetDirtyPageTable() -> std::unordered_map<page_id_t, lsn_t> {
   std::scoped_lock<std::mutex> lock(latch_);
+  return dirty_page_table_;
+}
 
-  if (page_table_.find(page_id) == page_table_.end()) {
-    return true;
+auto BufferPoolManager::FlushOldestDirtyPages(size_t max_pages) -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // Pages that are write latched are being changed right now, skip them rather than waiting with the latch held.
+  std::vector<page_id_t> page_ids;
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto it = dirty_pages_by_rec_lsn_.begin(); it != dirty_pages_by_rec_lsn_.end() && page_ids.size() < max_pages;
+       ++it) {
+    Page &page = pages_[page_table_[it->second]];
+    if (page.TryRLatch()) {
+      page_ids.push_back(it->second);
+      max_lsn = std::max(max_lsn, page.GetLSN());
+      page.RUnlatch();
+    }
   }
 
-  frame_id_t frame_id = page_table_[page_id];
-  if (pages_[frame_id].GetPinCount() > 0) {
-    return false;
+  // Make the log durable once for all of them, without the latch. The pages may change or leave meanwhile.
+  FlushLog(lock, max_lsn);
+  std::vector<frame_id_t> frame_ids;
+  for (page_id_t page_id : page_ids) {
+    auto it = page_table_.find(page_id);
+    if (it == page_table_.end() || !pages_[it->second].IsDirty() || !pages_[it->second].TryRLatch()) {
+      continue;
+    }
+    if (LogFlushNeeded(pages_[it->second].GetLSN())) {
+      pages_[it->second].RUnlatch();
+      continue;
+    }
+    frame_ids.push_back(it->second);
   }
+  WriteFrames(frame_ids);
+  for (frame_id_t frame_id : frame_ids) {
+    pages_[frame_id].RUnlatch();
+  }
+  return frame_ids.size();
+}
+
+auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  frame_id_t frame_id;
+  size_t num_log_flushes = 0;
+  while (true) {
+    if (page_table_.find(page_id) == page_table_.end()) {
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Erase(page_id);
+      }
+      return true;
+    }
+
+    frame_id = page_table_[page_id];
+    int unpinned = Page::PIN_EVICTABLE;
+    if (!pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, Page::PIN_CLAIMED)) {
+      return false;
+    }
+    lsn_t lsn = pages_[frame_id].GetLSN();
+    if (!pages_[frame_id].IsDirty() || !LogFlushNeeded(lsn)) {
+      break;
+    }
+    // Hand the frame back while the log is made durable without the latch, then start over.
+    pages_[frame_id].pin_count_ = Page::PIN_EVICTABLE;
+    if (num_log_flushes++ == MAX_LOG_FLUSH_RETRIES) {
+      return false;
+    }
+    FlushLog(lock, lsn);
+  }
+  pages_[frame_id].generation_++;
   if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+    WriteFrame(frame_id);
   }
 
   page_table_.erase(page_id);
+  UnswizzleFrame(frame_id);
+  DropSnapshotImage(page_id);
   replacer_->Remove(frame_id);
   free_list_.push_back(frame_id);
+  NotifyFrameWaiter();
 
-  pages_[frame_id].pin_count_ = 0;
   pages_[frame_id].ResetMemory();
   pages_[frame_id].is_dirty_ = false;
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
@@ -162,7 +361,371 @@ auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_.fetch_add(page_id_stride_); }
+
+void BufferPoolManager::SetPageIdPartition(size_t num_partitions, size_t partition_index) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(partition_index < num_partitions, "partition index out of range");
+  page_id_stride_ = static_cast<page_id_t>(num_partitions);
+  next_page_id_ = static_cast<page_id_t>(partition_index);
+}
+
+void BufferPoolManager::SetFrameWaitTimeout(std::chrono::milliseconds timeout) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  frame_wait_timeout_ = timeout;
+}
+
+auto BufferPoolManager::GetFrameWaitStats() -> FrameWaitStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return frame_wait_stats_;
+}
+
+void BufferPoolManager::SetChecksumPolicy(ChecksumPolicy policy, DiskManager *checksum_disk_manager) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  checksum_policy_ = policy;
+  checksum_table_ =
+      policy == ChecksumPolicy::Disabled ? nullptr : std::make_unique<PageChecksumTable>(checksum_disk_manager);
+}
+
+auto BufferPoolManager::GetChecksumFailures() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return checksum_failures_;
+}
+
+void BufferPoolManager::WriteFrame(frame_id_t frame_id) {
+  BUSTUB_ASSERT(!LogFlushNeeded(pages_[frame_id].GetLSN()), "the log must be durable up to the page LSN");
+  if (checksum_table_ != nullptr) {
+    checksum_table_->Record(pages_[frame_id].GetPageId(), ChecksumUtil::Crc32c(pages_[frame_id].GetData(), page_size_));
+    checksum_table_->Flush();
+  }
+  WritePageToDisk(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+
+  pages_[frame_id].is_dirty_ = false;
+  if (auto it = dirty_page_table_.find(pages_[frame_id].GetPageId()); it != dirty_page_table_.end()) {
+    dirty_pages_by_rec_lsn_.erase({it->second, it->first});
+    dirty_page_table_.erase(it);
+  }
+}
+
+void BufferPoolManager::WriteFrames(const std::vector<frame_id_t> &frame_ids) {
+  // The pages are read latched, so WriteFrame() finds their entries up to date and has nothing left to flush.
+  if (checksum_table_ != nullptr) {
+    for (frame_id_t frame_id : frame_ids) {
+      checksum_table_->Record(pages_[frame_id].GetPageId(),
+                              ChecksumUtil::Crc32c(pages_[frame_id].GetData(), page_size_));
+    }
+    checksum_table_->Flush();
+  }
+  for (frame_id_t frame_id : frame_ids) {
+    WriteFrame(frame_id);
+  }
+}
+
+auto BufferPoolManager::WriteResidentPage(std::unique_lock<std::mutex> &lock, page_id_t page_id) -> bool {
+  size_t num_log_flushes = 0;
+  while (true) {
+    auto it = page_table_.find(page_id);
+    if (it == page_table_.end()) {
+      return false;
+    }
+    frame_id_t frame_id = it->second;
+    if (!pages_[frame_id].TryRLatch()) {
+      // A writer holds the page. It may be waiting for the latch, e.g. to fetch the next page, so let it have it.
+      lock.unlock();
+      std::this_thread::yield();
+      lock.lock();
+      continue;
+    }
+    if (lsn_t lsn = pages_[frame_id].GetLSN(); LogFlushNeeded(lsn)) {
+      pages_[frame_id].RUnlatch();
+      if (num_log_flushes++ == MAX_LOG_FLUSH_RETRIES) {
+        return false;
+      }
+      FlushLog(lock, lsn);
+      continue;
+    }
+    WriteFrame(frame_id);
+    pages_[frame_id].RUnlatch();
+    return true;
+  }
+}
+
+auto BufferPoolManager::LogFlushNeeded(lsn_t lsn) -> bool {
+  if (!enable_logging || log_manager_ == nullptr) {
+    return false;
+  }
+  // LSNs at or past the log tail name no record, e.g. in a zeroed page, a page from an older log or a layout that
+  // does not keep an LSN in its header. LogManager::Flush() cannot make them durable, so they need no flush.
+  return std::min(lsn, log_manager_->GetNextLSN() - 1) > log_manager_->GetPersistentLSN();
+}
+
+void BufferPoolManager::FlushLog(std::unique_lock<std::mutex> &lock, lsn_t lsn) {
+  if (!LogFlushNeeded(lsn)) {
+    return;
+  }
+  lock.unlock();
+  log_manager_->Flush(lsn);
+  lock.lock();
+}
+
+void BufferPoolManager::PinFrame(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  // The replacer is told below that the frame is no longer evictable.
+  int pin_word = page.pin_count_.load();
+  while (!page.pin_count_.compare_exchange_weak(pin_word, (pin_word & ~Page::PIN_EVICTABLE) + 1)) {
+  }
+  if ((pin_word & ~Page::PIN_EVICTABLE) == 0) {
+    page.pin_lsn_ = GetLogTail();
+  }
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+}
+
+auto BufferPoolManager::TryPinUnlatched(Page *page) -> bool {
+  // The replacer may still consider the frame evictable, ClaimFrame() sorts that out.
+  int pin_word = page->pin_count_.load();
+  while (pin_word != Page::PIN_CLAIMED) {
+    if (page->pin_count_.compare_exchange_weak(pin_word, pin_word + 1)) {
+      if ((pin_word & ~Page::PIN_EVICTABLE) == 0) {
+        page->pin_lsn_ = GetLogTail();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManager::ClaimFrame(frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  int pin_word = page.pin_count_.load();
+  while (true) {
+    if (pin_word == Page::PIN_EVICTABLE) {
+      if (page.pin_count_.compare_exchange_weak(pin_word, Page::PIN_CLAIMED)) {
+        break;
+      }
+    } else if (page.pin_count_.compare_exchange_weak(pin_word, pin_word & ~Page::PIN_EVICTABLE)) {
+      // Pinned without the latch since it became evictable. The replacer dropped the frame, so track it again as
+      // pinned; its last unpin makes it evictable.
+      replacer_->RecordAccess(frame_id);
+      return false;
+    }
+  }
+  // Invalidate the frame cache entries for the page that is leaving.
+  page.generation_++;
+  return true;
+}
+
+auto BufferPoolManager::FetchCachedFrame(page_id_t page_id) -> Page * {
+  auto &entry = frame_cache.entries_[static_cast<size_t>(page_id) % FRAME_CACHE_SIZE];
+  if (entry.instance_id_ != instance_id_ || entry.page_id_ != page_id) {
+    return nullptr;
+  }
+  Page *page = entry.page_;
+  if (!TryPinUnlatched(page)) {
+    entry.page_id_ = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  // The generation only changes while the frame is claimed, so with the pin held it tells whether the page is there.
+  if (page->generation_.load() != entry.generation_) {
+    UnpinFrame(page, false);
+    entry.page_id_ = INVALID_PAGE_ID;
+    return nullptr;
+  }
+
+  // A hot page counts as accessed once per round of hits, which keeps it recent without a replacer update per hit.
+  entry.hit_ = true;
+  if (++frame_cache.num_hits_ == FRAME_CACHE_HITS) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    RecordFrameCacheHits();
+  }
+  return page;
+}
+
+void BufferPoolManager::CacheFrame(page_id_t page_id, frame_id_t frame_id) {
+  frame_cache.entries_[static_cast<size_t>(page_id) % FRAME_CACHE_SIZE] = {
+      instance_id_, page_id, &pages_[frame_id], pages_[frame_id].generation_.load(), false};
+}
+
+void BufferPoolManager::RecordFrameCacheHits() {
+  for (auto &entry : frame_cache.entries_) {
+    if (entry.instance_id_ != instance_id_ || !entry.hit_) {
+      continue;
+    }
+    // Skip frames that went to another page since.
+    if (entry.page_->generation_.load() == entry.generation_) {
+      replacer_->RecordAccess(static_cast<frame_id_t>(entry.page_ - pages_));
+    }
+    entry.hit_ = false;
+  }
+  frame_cache.num_hits_ = 0;
+}
+
+void BufferPoolManager::UnswizzleFrame(frame_id_t frame_id) {
+  if (frame_swips_[frame_id] != nullptr) {
+    frame_swips_[frame_id]->word_.store(Swip::Unswizzled(pages_[frame_id].GetPageId()), std::memory_order_release);
+    frame_swips_[frame_id] = nullptr;
+  }
+}
+
+void BufferPoolManager::DropSnapshotImage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(snapshot_latch_);
+  snapshot_images_.erase(page_id);
+}
+
+auto BufferPoolManager::GetLogTail() -> lsn_t {
+  return log_manager_ != nullptr ? log_manager_->GetNextLSN() : INVALID_LSN;
+}
+
+void BufferPoolManager::SetCompressedCacheCapacity(size_t capacity) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  compressed_cache_ = capacity == 0 ? nullptr : std::make_unique<CompressedPageCache>(capacity, page_size_);
+}
+
+void BufferPoolManager::WritePageToDisk(page_id_t page_id, const char *page_data) {
+  if (page_size_ >= BUSTUB_PAGE_SIZE) {
+    size_t blocks = page_size_ / BUSTUB_PAGE_SIZE;
+    for (size_t i = 0; i < blocks; i++) {
+      disk_manager_->WritePage(static_cast<page_id_t>(page_id * blocks + i), page_data + i * BUSTUB_PAGE_SIZE);
+    }
+    return;
+  }
+  size_t pages_per_block = BUSTUB_PAGE_SIZE / page_size_;
+  auto block_id = static_cast<page_id_t>(page_id / pages_per_block);
+  char block[BUSTUB_PAGE_SIZE];
+  disk_manager_->ReadPage(block_id, block);
+  memcpy(block + (page_id % pages_per_block) * page_size_, page_data, page_size_);
+  disk_manager_->WritePage(block_id, block);
+}
+
+void BufferPoolManager::ReadPageFromDisk(page_id_t page_id, char *page_data) {
+  if (page_size_ >= BUSTUB_PAGE_SIZE) {
+    size_t blocks = page_size_ / BUSTUB_PAGE_SIZE;
+    for (size_t i = 0; i < blocks; i++) {
+      disk_manager_->ReadPage(static_cast<page_id_t>(page_id * blocks + i), page_data + i * BUSTUB_PAGE_SIZE);
+    }
+    return;
+  }
+  size_t pages_per_block = BUSTUB_PAGE_SIZE / page_size_;
+  char block[BUSTUB_PAGE_SIZE];
+  disk_manager_->ReadPage(static_cast<page_id_t>(page_id / pages_per_block), block);
+  memcpy(page_data, block + (page_id % pages_per_block) * page_size_, page_size_);
+}
+
+auto BufferPoolManager::ReadFrame(page_id_t page_id, frame_id_t frame_id) -> bool {
+  if (compressed_cache_ != nullptr && compressed_cache_->Lookup(page_id, pages_[frame_id].data_)) {
+    return true;
+  }
+  ReadPageFromDisk(page_id, pages_[frame_id].data_);
+  if (checksum_table_ == nullptr ||
+      checksum_table_->Verify(page_id, ChecksumUtil::Crc32c(pages_[frame_id].GetData(), page_size_))) {
+    return true;
+  }
+
+  checksum_failures_++;
+  if (checksum_policy_ == ChecksumPolicy::Warn) {
+    LOG_WARN("page %d failed checksum verification", page_id);
+    return true;
+  }
+  return false;
+}
+
+auto BufferPoolManager::TryAcquireFrame(frame_id_t *frame_id, lsn_t *flush_lsn, uint64_t *cache_ticket) -> bool {
+  *flush_lsn = INVALID_LSN;
+  *cache_ticket = 0;
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+
+  do {
+    if (bool evict_success = replacer_->Evict(frame_id); !evict_success) {
+      return false;
+    }
+  } while (!ClaimFrame(*frame_id));
+  if (lsn_t lsn = pages_[*frame_id].GetLSN(); pages_[*frame_id].IsDirty() && LogFlushNeeded(lsn)) {
+    // Write-ahead rule: the page may only be written once its log records are durable. Rather than flushing the log
+    // with the latch held, hand the victim back to the replacer and let the caller flush and retry.
+    pages_[*frame_id].pin_count_ = Page::PIN_EVICTABLE;
+    replacer_->RecordAccess(*frame_id);
+    replacer_->SetEvictable(*frame_id, true);
+    *flush_lsn = lsn;
+    return false;
+  }
+  if (pages_[*frame_id].IsDirty()) {
+    WriteFrame(*frame_id);
+  }
+  if (compressed_cache_ != nullptr) {
+    *cache_ticket = compressed_cache_->Reserve(pages_[*frame_id].GetPageId());
+  }
+  page_table_.erase(pages_[*frame_id].GetPageId());
+  UnswizzleFrame(*frame_id);
+  DropSnapshotImage(pages_[*frame_id].GetPageId());
+  return true;
+}
+
+auto BufferPoolManager::AcquireFrame(std::unique_lock<std::mutex> &lock, frame_id_t *frame_id, bool wait) -> bool {
+  auto try_acquire = [&]() {
+    lsn_t flush_lsn;
+    uint64_t cache_ticket;
+    size_t num_log_flushes = 0;
+    while (!TryAcquireFrame(frame_id, &flush_lsn, &cache_ticket)) {
+      // Every flush makes the victim writable, but others may keep dirtying the next victims; give up eventually.
+      if (flush_lsn == INVALID_LSN || num_log_flushes++ == MAX_LOG_FLUSH_RETRIES) {
+        return false;
+      }
+      FlushLog(lock, flush_lsn);
+    }
+    if (cache_ticket != 0) {
+      // The frame is claimed, so its old page stays put while it is compressed into the cache without the latch.
+      lock.unlock();
+      compressed_cache_->Insert(pages_[*frame_id].GetPageId(), pages_[*frame_id].GetData(), cache_ticket);
+      lock.lock();
+    }
+    return true;
+  };
+
+  // Don't overtake callers that are already queued for a frame.
+  if (frame_waiters_.empty() && try_acquire()) {
+    return true;
+  }
+  if (!wait || frame_wait_timeout_.count() == 0) {
+    return false;
+  }
+
+  FrameWaiter waiter;
+  auto it = frame_waiters_.insert(frame_waiters_.end(), &waiter);
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + frame_wait_timeout_;
+
+  bool acquired = false;
+  while (true) {
+    if (frame_waiters_.front() == &waiter && try_acquire()) {
+      acquired = true;
+      break;
+    }
+    if (waiter.cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+      acquired = frame_waiters_.front() == &waiter && try_acquire();
+      break;
+    }
+  }
+  frame_waiters_.erase(it);
+
+  frame_wait_stats_.waits_++;
+  frame_wait_stats_.wait_time_ += std::chrono::steady_clock::now() - start;
+  if (!acquired) {
+    frame_wait_stats_.timeouts_++;
+  }
+  // More than one frame may have been released while we were waiting, pass the turn on.
+  NotifyFrameWaiter();
+  return acquired;
+}
+
+void BufferPoolManager::NotifyFrameWaiter() {
+  if (!frame_waiters_.empty() && (!free_list_.empty() || replacer_->Size() > 0)) {
+    frame_waiters_.front()->cv_.notify_one();
+  }
+}
 
 auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
   Page *page = FetchPage(page_id);
@@ -171,16 +734,167 @@ auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
 
 auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
   Page *page = FetchPage(page_id);
-  page->RLatch();
+  if (page != nullptr) {
+    page->RLatch();
+  }
   return {this, page};
 }
 
 auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
   Page *page = FetchPage(page_id);
-  page->WLatch();
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::TryFetchPageRead(page_id_t page_id, TryFetchStatus *status) -> ReadPageGuard {
+  Page *page = FetchFrame(page_id, false, status);
+  if (page != nullptr && !page->TryRLatch()) {
+    UnpinFrame(page, false);
+    page = nullptr;
+    if (status != nullptr) {
+      *status = TryFetchStatus::LatchBusy;
+    }
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::TryFetchPageWrite(page_id_t page_id, TryFetchStatus *status) -> WritePageGuard {
+  Page *page = FetchFrame(page_id, false, status);
+  if (page != nullptr && !page->TryWLatch()) {
+    UnpinFrame(page, false);
+    page = nullptr;
+    if (status != nullptr) {
+      *status = TryFetchStatus::LatchBusy;
+    }
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+  Page *page = FetchPage(page_id);
+  return {this, page};
+}
+
+auto BufferPoolManager::FetchSwizzledPage(Swip *swip) -> Page * {
+  uint64_t word = swip->word_.load(std::memory_order_acquire);
+  if (Swip::IsSwizzled(word) && OwnsFrame(Swip::FrameOf(word))) {
+    // A pinned frame cannot be evicted, so pin it without the latch.
+    Page *page = Swip::FrameOf(word);
+    if (TryPinUnlatched(page)) {
+      // The frame may have been given to another page before the pin. A swip is unswizzled before its frame is
+      // reused, so finding it unchanged proves that the frame still holds its page.
+      if (swip->word_.load(std::memory_order_acquire) == word) {
+        return page;
+      }
+      UnpinFrame(page, false);
+    }
+  }
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  word = swip->word_.load(std::memory_order_acquire);
+  if (!Swip::IsSwizzled(word) || !OwnsFrame(Swip::FrameOf(word))) {
+    return nullptr;
+  }
+  // Eviction unswizzles under the latch, so the frame holds the page: skip the page table.
+  Page *page = Swip::FrameOf(word);
+  PinFrame(static_cast<frame_id_t>(page - pages_));
+  return page;
+}
+
+auto BufferPoolManager::FetchPage(Swip *swip, AccessType access_type) -> Page * {
+  uint64_t word;
+  do {
+    if (Page *page = FetchSwizzledPage(swip); page != nullptr) {
+      return page;
+    }
+    word = swip->word_.load(std::memory_order_acquire);
+    // Swizzled into another buffer pool's frame, which only that buffer pool can pin; retrying would spin forever.
+    if (Swip::IsSwizzled(word) && !OwnsFrame(Swip::FrameOf(word))) {
+      return nullptr;
+    }
+  } while (Swip::IsSwizzled(word));
+
+  page_id_t page_id = Swip::PageIdOf(word);
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = FetchPage(page_id, access_type);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  // The page is pinned, so it stays in this frame. Swizzle unless another swip owns the frame or this one changed.
+  auto frame_id = static_cast<frame_id_t>(page - pages_);
+  uint64_t unswizzled = word;
+  if (frame_swips_[frame_id] == nullptr &&
+      swip->word_.compare_exchange_strong(unswizzled, Swip::Swizzled(page), std::memory_order_release)) {
+    frame_swips_[frame_id] = swip;
+  }
+  return page;
+}
+
+auto BufferPoolManager::FetchPageBasic(Swip *swip) -> BasicPageGuard {
+  Page *page = FetchPage(swip);
+  return {this, page};
+}
+
+auto BufferPoolManager::FetchPageRead(Swip *swip) -> ReadPageGuard {
+  Page *page = FetchPage(swip);
+  if (page != nullptr) {
+    page->RLatch();
+  }
   return {this, page};
 }
 
+auto BufferPoolManager::FetchPageWrite(Swip *swip) -> WritePageGuard {
+  Page *page = FetchPage(swip);
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return {this, page};
+}
+
+void BufferPoolManager::ReleaseSwip(Swip *swip) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  uint64_t word = swip->word_.load(std::memory_order_acquire);
+  if (Swip::IsSwizzled(word) && OwnsFrame(Swip::FrameOf(word))) {
+    auto frame_id = static_cast<frame_id_t>(Swip::FrameOf(word) - pages_);
+    BUSTUB_ASSERT(frame_swips_[frame_id] == swip, "a swizzled swip is registered with its frame");
+    UnswizzleFrame(frame_id);
+  }
+}
+
+auto BufferPoolManager::FetchPageSnapshot(page_id_t page_id) -> PageSnapshot {
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  frame_id_t frame_id = static_cast<frame_id_t>(page - pages_);
+
+  page->RLatch();
+  uint64_t version = page->GetVersion();
+  std::shared_ptr<const char[]> data;
+  {
+    std::scoped_lock<std::mutex> lock(snapshot_latch_);
+    auto it = snapshot_images_.find(page_id);
+    if (it != snapshot_images_.end() && it->second.frame_id_ == frame_id && it->second.version_ == version) {
+      data = it->second.data_.lock();
+    }
+  }
+  if (data == nullptr) {
+    std::shared_ptr<char[]> copy(new char[page_size_]);
+    memcpy(copy.get(), page->GetData(), page_size_);
+    data = copy;
+    std::scoped_lock<std::mutex> lock(snapshot_latch_);
+    snapshot_images_.insert_or_assign(page_id, SnapshotImage{frame_id, version, data});
+  }
+  page->RUnlatch();
+  UnpinPage(page_id, false);
+  return {page_id, version, std::move(data)};
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
   Page *page = NewPage(page_id);
   return {this, page};
@@ -0,0 +1,254 @@
+#include "buffer/buffer_pool_stress.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto BufferPoolStressResult::TotalOps() const -> size_t { return std::accumulate(ops_.begin(), ops_.end(), size_t{0}); }
+
+auto BufferPoolStressResult::OpsPerSecond() const -> double {
+  double seconds = std::chrono::duration<double>(elapsed_).count();
+  return seconds > 0 ? static_cast<double>(TotalOps()) / seconds : 0;
+}
+
+auto BufferPoolStressResult::ToString() const -> std::string {
+  return fmt::format("{} ops in {:.3f}s ({:.0f} ops/s), {} skipped on a full pool, {} failures{}{}", TotalOps(),
+                     std::chrono::duration<double>(elapsed_).count(), OpsPerSecond(), pool_full_, failures_,
+                     failures_ > 0 ? ", first: " : "", first_failure_);
+}
+
+BufferPoolStress::BufferPoolStress(BufferPoolManager *bpm, BufferPoolStressOptions options)
+    : bpm_(bpm), options_(options) {
+  // Threads racing past max_pages_ may each create one more page.
+  model_ = std::make_unique<ModelPage[]>(options_.max_pages_ + options_.num_threads_);
+}
+
+auto BufferPoolStress::Run() -> BufferPoolStressResult {
+  std::vector<ThreadResult> thread_results(options_.num_threads_);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options_.num_threads_; i++) {
+    threads.emplace_back([this, i, &thread_results] { RunThread(i, &thread_results[i]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BufferPoolStressResult result;
+  result.elapsed_ = std::chrono::steady_clock::now() - start;
+  thread_results.emplace_back();
+  CheckAllPages(&thread_results.back());
+  for (const auto &thread_result : thread_results) {
+    for (size_t op = 0; op < NUM_STRESS_OPS; op++) {
+      result.ops_[op] += thread_result.ops_[op];
+    }
+    result.pool_full_ += thread_result.pool_full_;
+    result.failures_ += thread_result.failures_;
+    if (result.first_failure_.empty()) {
+      result.first_failure_ = thread_result.first_failure_;
+    }
+  }
+  return result;
+}
+
+BufferPoolStress::LockstepTurn::LockstepTurn(BufferPoolStress *stress, size_t thread_index)
+    : stress_(stress->options_.lockstep_ ? stress : nullptr) {
+  if (stress_ != nullptr) {
+    std::unique_lock<std::mutex> lock(stress_->turn_latch_);
+    stress_->turn_cv_.wait(lock, [&] { return stress_->turn_ % stress_->options_.num_threads_ == thread_index; });
+  }
+}
+
+BufferPoolStress::LockstepTurn::~LockstepTurn() {
+  if (stress_ != nullptr) {
+    {
+      std::scoped_lock<std::mutex> lock(stress_->turn_latch_);
+      stress_->turn_++;
+    }
+    stress_->turn_cv_.notify_all();
+  }
+}
+
+void BufferPoolStress::RunThread(size_t thread_index, ThreadResult *result) {
+  std::mt19937_64 rng(options_.seed_ * 0x9e3779b97f4a7c15ULL + thread_index);
+  std::discrete_distribution<size_t> pick_op(options_.weights_.begin(), options_.weights_.end());
+  std::uniform_real_distribution<double> pick_hot(0, 1);
+
+  auto fail = [result](std::string message) {
+    if (result->failures_++ == 0) {
+      result->first_failure_ = std::move(message);
+    }
+  };
+  auto pick_page = [&]() -> page_id_t {
+    size_t num_pages = std::max<size_t>(1, num_pages_.load());
+    size_t range = pick_hot(rng) < options_.hot_fraction_ ? std::max<size_t>(1, num_pages / 16) : num_pages;
+    return static_cast<page_id_t>(std::uniform_int_distribution<size_t>(0, range - 1)(rng));
+  };
+
+  for (size_t i = 0; i < options_.ops_per_thread_; i++) {
+    // Every thread runs the same number of operations, so the round-robin turns never skip a finished thread.
+    LockstepTurn turn(this, thread_index);
+    auto op = static_cast<StressOp>(pick_op(rng));
+    result->ops_[static_cast<size_t>(op)]++;
+
+    if (op == StressOp::NewPage) {
+      if (num_pages_.load() >= options_.max_pages_) {
+        continue;
+      }
+      page_id_t page_id;
+      BasicPageGuard guard = bpm_->NewPageGuarded(&page_id);
+      if (!guard.IsValid()) {
+        result->pool_full_++;
+        continue;
+      }
+      if (page_id < 0 || static_cast<size_t>(page_id) >= options_.max_pages_ + options_.num_threads_) {
+        fail(fmt::format("NewPage returned page id {} out of range", page_id));
+        continue;
+      }
+      ModelPage &model = model_[page_id];
+      std::scoped_lock<std::shared_mutex> model_lock(model.latch_);
+      if (model.live_) {
+        fail(fmt::format("NewPage returned page id {} twice", page_id));
+        continue;
+      }
+      WritePageGuard write_guard = guard.UpgradeWrite();
+      Stamp(page_id, write_guard.GetDataMut(), 0);
+      model.version_ = 0;
+      model.live_ = true;
+      size_t num_pages = num_pages_.load();
+      while (num_pages <= static_cast<size_t>(page_id) &&
+             !num_pages_.compare_exchange_weak(num_pages, static_cast<size_t>(page_id) + 1)) {
+      }
+      continue;
+    }
+
+    if (op == StressOp::FlushAllPages) {
+      bpm_->FlushAllPages();
+      continue;
+    }
+
+    page_id_t page_id = pick_page();
+    ModelPage &model = model_[page_id];
+    if (op == StressOp::DeletePage) {
+      // With the model latch held exclusively nobody else has the page pinned, so the deletion must succeed.
+      std::scoped_lock<std::shared_mutex> model_lock(model.latch_);
+      if (model.live_) {
+        if (!bpm_->DeletePage(page_id)) {
+          fail(fmt::format("DeletePage({}) failed on an unpinned page", page_id));
+        }
+        model.live_ = false;
+      }
+      continue;
+    }
+
+    std::shared_lock<std::shared_mutex> model_lock(model.latch_);
+    if (!model.live_) {
+      continue;
+    }
+    switch (op) {
+      case StressOp::FetchRead: {
+        ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+        if (!guard.IsValid()) {
+          result->pool_full_++;
+          break;
+        }
+        if (auto error = CheckStamp(page_id, guard.GetData(), model.version_.load()); !error.empty()) {
+          fail("FetchPageRead: " + error);
+        }
+        break;
+      }
+      case StressOp::FetchWrite: {
+        WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+        if (!guard.IsValid()) {
+          result->pool_full_++;
+          break;
+        }
+        uint64_t version = model.version_.load();
+        if (auto error = CheckStamp(page_id, guard.GetData(), version); !error.empty()) {
+          fail("FetchPageWrite: " + error);
+        }
+        Stamp(page_id, guard.GetDataMut(), version + 1);
+        model.version_ = version + 1;
+        break;
+      }
+      case StressOp::FetchUnpin: {
+        Page *page = bpm_->FetchPage(page_id);
+        if (page == nullptr) {
+          result->pool_full_++;
+          break;
+        }
+        if (page->GetPageId() != page_id) {
+          fail(fmt::format("FetchPage({}) returned page {}", page_id, page->GetPageId()));
+        }
+        page->RLatch();
+        if (auto error = CheckStamp(page_id, page->GetData(), model.version_.load()); !error.empty()) {
+          fail("FetchPage: " + error);
+        }
+        page->RUnlatch();
+        if (!bpm_->UnpinPage(page_id, false)) {
+          fail(fmt::format("UnpinPage({}) failed on a pinned page", page_id));
+        }
+        break;
+      }
+      case StressOp::FlushPage:
+        bpm_->FlushPage(page_id);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+auto BufferPoolStress::CheckStamp(page_id_t page_id, const char *data, uint64_t version) -> std::string {
+  page_id_t stamped_page_id;
+  uint64_t stamped_version;
+  uint64_t tail_version;
+  memcpy(&stamped_page_id, data + STAMP_OFFSET, sizeof(page_id_t));
+  memcpy(&stamped_version, data + STAMP_OFFSET + sizeof(uint64_t), sizeof(uint64_t));
+  memcpy(&tail_version, data + bpm_->GetPageSize() - sizeof(uint64_t), sizeof(uint64_t));
+  if (stamped_page_id != page_id || stamped_version != version || tail_version != version) {
+    return fmt::format("page {} holds page {} version {} (tail {}), expected version {}", page_id, stamped_page_id,
+                       stamped_version, tail_version, version);
+  }
+  return "";
+}
+
+void BufferPoolStress::Stamp(page_id_t page_id, char *data, uint64_t version) {
+  memcpy(data + STAMP_OFFSET, &page_id, sizeof(page_id_t));
+  memcpy(data + STAMP_OFFSET + sizeof(uint64_t), &version, sizeof(uint64_t));
+  memcpy(data + bpm_->GetPageSize() - sizeof(uint64_t), &version, sizeof(uint64_t));
+}
+
+void BufferPoolStress::CheckAllPages(ThreadResult *result) {
+  auto fail = [result](std::string message) {
+    if (result->failures_++ == 0) {
+      result->first_failure_ = std::move(message);
+    }
+  };
+  // Nothing is pinned anymore, so every fetch must succeed. Flushing first and going through more pages than there
+  // are frames reads most pages back from disk.
+  bpm_->FlushAllPages();
+  for (size_t i = 0; i < num_pages_.load(); i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    if (!model_[i].live_) {
+      continue;
+    }
+    ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+      fail(fmt::format("cannot fetch page {} with nothing pinned", page_id));
+      continue;
+    }
+    if (auto error = CheckStamp(page_id, guard.GetData(), model_[i].version_.load()); !error.empty()) {
+      fail("final check: " + error);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "common/util/compression_util.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity, size_t page_size)
+    : capacity_(capacity), page_size_(page_size) {}
+
+auto CompressedPageCache::Reserve(page_id_t page_id) -> uint64_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  uint64_t ticket = next_ticket_++;
+  reservations_[page_id] = ticket;
+  return ticket;
+}
+
+void CompressedPageCache::Insert(page_id_t page_id, const char *page_data, uint64_t ticket) {
+  // Compress before taking the cache latch, so concurrent evictions compress in parallel. A page that does not
+  // compress is still worth caching, it saves a disk read.
+  thread_local std::vector<char> buffer;
+  buffer.resize(page_size_);
+  size_t size = CompressionUtil::Compress(page_data, page_size_, buffer.data(), page_size_ - 1);
+  const char *source = buffer.data();
+  if (size == 0) {
+    size = page_size_;
+    source = page_data;
+  }
+  auto data = std::make_unique<char[]>(size);
+  memcpy(data.get(), source, size);
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto reservation = reservations_.find(page_id);
+  if (reservation == reservations_.end() || reservation->second != ticket) {
+    return;
+  }
+  reservations_.erase(reservation);
+  if (size + ENTRY_OVERHEAD > capacity_) {
+    return;
+  }
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    RemoveEntry(it);
+  }
+  while (stats_.memory_used_ + size + ENTRY_OVERHEAD > capacity_) {
+    RemoveEntry(entries_.find(lru_list_.front()));
+    stats_.evictions_++;
+  }
+
+  lru_list_.push_back(page_id);
+  entries_.emplace(page_id, Entry{std::move(data), size, std::prev(lru_list_.end())});
+  stats_.memory_used_ += size + ENTRY_OVERHEAD;
+  stats_.num_pages_++;
+  stats_.insertions_++;
+}
+
+auto CompressedPageCache::Lookup(page_id_t page_id, char *page_data) -> bool {
+  std::unique_ptr<char[]> data;
+  size_t size;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    // The page is about to be resident again, so a pending insertion of it would be outdated.
+    reservations_.erase(page_id);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+      stats_.misses_++;
+      return false;
+    }
+    stats_.hits_++;
+    data = std::move(it->second.data_);
+    size = it->second.size_;
+    RemoveEntry(it);
+  }
+
+  if (size == page_size_) {
+    memcpy(page_data, data.get(), page_size_);
+    return true;
+  }
+  return CompressionUtil::Decompress(data.get(), size, page_data, page_size_) == page_size_;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  reservations_.erase(page_id);
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    RemoveEntry(it);
+  }
+}
+
+auto CompressedPageCache::GetStats() -> CompressedPageCacheStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return stats_;
+}
+
+void CompressedPageCache::RemoveEntry(std::unordered_map<page_id_t, Entry>::iterator it) {
+  stats_.memory_used_ -= it->second.size_ + ENTRY_OVERHEAD;
+  stats_.num_pages_--;
+  lru_list_.erase(it->second.lru_pos_);
+  entries_.erase(it);
+}
+
+}  // namespace bustub
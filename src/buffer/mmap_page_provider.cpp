@@ -0,0 +1,212 @@
+#include "buffer/mmap_page_provider.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+MmapPageProvider::MmapPageProvider(const std::string &db_file, size_t max_pages, size_t page_size,
+                                   size_t prefetch_pages)
+    : db_file_(db_file),
+      max_pages_(max_pages),
+      page_size_(page_size),
+      prefetch_pages_(prefetch_pages),
+      os_page_size_(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+      pages_(max_pages) {
+  BUSTUB_ASSERT(page_size_ > 0 && page_size_ % CACHE_LINE_SIZE == 0, "page size must be a multiple of a cache line");
+
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception(fmt::format("cannot open db file {}: {}", db_file, strerror(errno)));
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    close(fd_);
+    throw Exception(fmt::format("cannot stat db file {}: {}", db_file, strerror(errno)));
+  }
+  size_t num_pages = static_cast<size_t>(st.st_size) / page_size_;
+  if (num_pages > max_pages_) {
+    close(fd_);
+    throw Exception(fmt::format("db file {} has {} pages, more than the maximum of {}", db_file, num_pages, max_pages_));
+  }
+  // A partially written last page can only be left by a crash, cut it off so the next new page starts out zeroed.
+  if (static_cast<size_t>(st.st_size) != num_pages * page_size_ &&
+      ftruncate(fd_, static_cast<off_t>(num_pages * page_size_)) != 0) {
+    close(fd_);
+    throw Exception(fmt::format("cannot truncate db file {}: {}", db_file, strerror(errno)));
+  }
+  next_page_id_ = static_cast<page_id_t>(num_pages);
+  file_pages_ = num_pages;
+
+  // Reserve the address space for the largest file up front, so pages never move while the file grows.
+  void *data = mmap(nullptr, max_pages_ * page_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    close(fd_);
+    throw Exception(fmt::format("cannot map db file {}: {}", db_file, strerror(errno)));
+  }
+  data_ = static_cast<char *>(data);
+  if (prefetch_pages_ > 0) {
+    // Scans read ahead explicitly, so the OS read-ahead would only waste memory on point lookups.
+    madvise(data_, max_pages_ * page_size_, MADV_RANDOM);
+  }
+}
+
+MmapPageProvider::~MmapPageProvider() {
+  for (auto &page : pages_) {
+    delete page.load();
+  }
+  // Unmapping keeps the dirty pages in the page cache, msync() only makes them durable now.
+  msync(data_, file_pages_.load() * page_size_, MS_SYNC);
+  munmap(data_, max_pages_ * page_size_);
+  // Drop the pages the file was grown by in advance but that were never handed out.
+  ftruncate(fd_, static_cast<off_t>(next_page_id_.load()) * static_cast<off_t>(page_size_));
+  close(fd_);
+}
+
+auto MmapPageProvider::NewPage(page_id_t *page_id) -> Page * {
+  page_id_t new_page_id = next_page_id_.load();
+  do {
+    if (static_cast<size_t>(new_page_id) >= max_pages_) {
+      return nullptr;
+    }
+  } while (!next_page_id_.compare_exchange_weak(new_page_id, new_page_id + 1));
+
+  EnsureFileSize(static_cast<size_t>(new_page_id) + 1);
+  *page_id = new_page_id;
+  return GetPage(new_page_id);
+}
+
+auto MmapPageProvider::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
+  Page *page = NewPage(page_id);
+  return {nullptr, page};
+}
+
+auto MmapPageProvider::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  // The file may still be growing for a page id that was just handed out.
+  if (page_id < 0 || page_id >= next_page_id_.load() || static_cast<size_t>(page_id) >= file_pages_.load()) {
+    return nullptr;
+  }
+  if (access_type == AccessType::Scan && prefetch_pages_ > 0 && static_cast<size_t>(page_id) % prefetch_pages_ == 0) {
+    // One hint per window of pages keeps the system calls off the per-page path.
+    Prefetch(page_id, prefetch_pages_);
+  }
+  return GetPage(page_id);
+}
+
+auto MmapPageProvider::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
+  Page *page = FetchPage(page_id);
+  return {nullptr, page};
+}
+
+auto MmapPageProvider::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
+  Page *page = FetchPage(page_id);
+  if (page != nullptr) {
+    page->RLatch();
+  }
+  return {nullptr, page};
+}
+
+auto MmapPageProvider::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+  Page *page = FetchPage(page_id);
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return {nullptr, page};
+}
+
+auto MmapPageProvider::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+  Page *page = FetchPage(page_id);
+  return {nullptr, page};
+}
+
+auto MmapPageProvider::UnpinPage(page_id_t page_id, [[maybe_unused]] bool is_dirty,
+                                 [[maybe_unused]] AccessType access_type) -> bool {
+  return page_id >= 0 && page_id < next_page_id_.load();
+}
+
+auto MmapPageProvider::FlushPage(page_id_t page_id) -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= file_pages_.load()) {
+    return false;
+  }
+  size_t begin = static_cast<size_t>(page_id) * page_size_ / os_page_size_ * os_page_size_;
+  size_t end = (static_cast<size_t>(page_id) + 1) * page_size_;
+  if (msync(data_ + begin, end - begin, MS_SYNC) != 0) {
+    throw Exception(fmt::format("I/O error while writing page {}: {}", page_id, strerror(errno)));
+  }
+  return true;
+}
+
+void MmapPageProvider::FlushAllPages() {
+  size_t length = file_pages_.load() * page_size_;
+  if (length > 0 && msync(data_, length, MS_SYNC) != 0) {
+    throw Exception(fmt::format("I/O error while writing db file {}: {}", db_file_, strerror(errno)));
+  }
+}
+
+auto MmapPageProvider::DeletePage(page_id_t page_id) -> bool {
+  if (page_id < 0 || page_id >= next_page_id_.load() || static_cast<size_t>(page_id) >= file_pages_.load()) {
+    return false;
+  }
+  memset(data_ + static_cast<size_t>(page_id) * page_size_, 0, page_size_);
+  // The zeroed page stays in the page cache until it is written back, only the mapping is dropped.
+  Advise(page_id, 1, MADV_DONTNEED);
+  return true;
+}
+
+void MmapPageProvider::Prefetch(page_id_t page_id, size_t num_pages) {
+  Advise(page_id, num_pages, MADV_WILLNEED);
+}
+
+auto MmapPageProvider::GetPage(page_id_t page_id) -> Page * {
+  auto &slot = pages_[page_id];
+  Page *page = slot.load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  auto *new_page = new Page(page_id, data_ + static_cast<size_t>(page_id) * page_size_, page_size_);
+  if (slot.compare_exchange_strong(page, new_page, std::memory_order_acq_rel)) {
+    return new_page;
+  }
+  // Another thread created the descriptor first.
+  delete new_page;
+  return page;
+}
+
+void MmapPageProvider::EnsureFileSize(size_t num_pages) {
+  if (file_pages_.load() >= num_pages) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(file_latch_);
+  size_t file_pages = file_pages_.load();
+  if (file_pages >= num_pages) {
+    return;
+  }
+  // Grow geometrically, so appending pages does not truncate the file every time.
+  size_t new_file_pages = std::min(max_pages_, std::max(num_pages, file_pages * 2));
+  if (ftruncate(fd_, static_cast<off_t>(new_file_pages * page_size_)) != 0) {
+    throw Exception(fmt::format("cannot grow db file {}: {}", db_file_, strerror(errno)));
+  }
+  file_pages_ = new_file_pages;
+}
+
+void MmapPageProvider::Advise(page_id_t page_id, size_t num_pages, int advice) {
+  size_t file_pages = file_pages_.load();
+  if (page_id < 0 || static_cast<size_t>(page_id) >= file_pages) {
+    return;
+  }
+  size_t end_page = std::min(file_pages, static_cast<size_t>(page_id) + num_pages);
+  size_t begin = static_cast<size_t>(page_id) * page_size_ / os_page_size_ * os_page_size_;
+  size_t end = end_page * page_size_;
+  // The advice is only a hint, failures are ignored.
+  madvise(data_ + begin, end - begin, advice);
+}
+
+}  // namespace bustub
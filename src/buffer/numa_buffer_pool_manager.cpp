@@ -0,0 +1,260 @@
+#include "buffer/numa_buffer_pool_manager.h"
+
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+#include "common/util/numa_util.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+NumaBufferPoolManager::NumaBufferPoolManager(size_t pool_size_per_node, DiskManager *disk_manager, size_t replacer_k,
+                                             LogManager *log_manager, size_t page_size)
+    : partitions_(NumaUtil::NumNodes()) {
+  // Small pages are written by a read-modify-write of their disk block under the latch of one partition, which would
+  // lose the updates another partition makes to the same block concurrently.
+  if (page_size != BUSTUB_PAGE_SIZE) {
+    throw Exception(fmt::format("NumaBufferPoolManager needs pages of {} bytes, not {}", BUSTUB_PAGE_SIZE, page_size));
+  }
+  // Build every partition on a thread bound to its node, so that its frames are first touched there.
+  std::vector<std::thread> builders;
+  for (size_t node = 0; node < partitions_.size(); node++) {
+    builders.emplace_back([&, node] {
+      NumaUtil::BindCurrentThread(node);
+      partitions_[node] =
+          std::make_unique<BufferPoolManager>(pool_size_per_node, disk_manager, replacer_k, log_manager, page_size);
+      partitions_[node]->SetPageIdPartition(partitions_.size(), node);
+    });
+  }
+  for (auto &builder : builders) {
+    builder.join();
+  }
+}
+
+auto NumaBufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+  size_t local = NumaUtil::CurrentNode() % partitions_.size();
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    Page *page = partitions_[(local + i) % partitions_.size()]->NewPage(page_id);
+    if (page != nullptr) {
+      if (i != 0) {
+        remote_allocations_++;
+      }
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto NumaBufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
+  Page *page = NewPage(page_id);
+  return {page == nullptr ? nullptr : PartitionOf(*page_id), page};
+}
+
+auto NumaBufferPoolManager::FetchRouted(page_id_t page_id, AccessType access_type, BufferPoolManager **partition)
+    -> Page * {
+  RouteStripe &stripe = StripeOf(page_id);
+  if (partitions_.size() > 1) {
+    {
+      std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+      *partition = partitions_[HomeOf(stripe, page_id)].get();
+      TryFetchStatus status;
+      Page *page = (*partition)->TryFetchPage(page_id, &status);
+      if (page != nullptr || status != TryFetchStatus::NoFrame) {
+        return page;
+      }
+    }
+    if (Page *page = MovePage(stripe, page_id, partition); page != nullptr) {
+      return page;
+    }
+  }
+
+  // No partition has a frame right now. Wait for one in the home, which may keep the stripe shared for up to the frame
+  // wait timeout, but never blocks fetches of other pages in the stripe.
+  std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+  *partition = partitions_[HomeOf(stripe, page_id)].get();
+  return (*partition)->FetchPage(page_id, access_type);
+}
+
+auto NumaBufferPoolManager::MovePage(RouteStripe &stripe, page_id_t page_id, BufferPoolManager **partition) -> Page * {
+  // The home has no frame for the page, so the page is not resident anywhere. Holding the stripe exclusively keeps it
+  // that way until the page is brought into the first partition with a free frame, which becomes its new home. None of
+  // the fetches waits for a frame, so the stripe is only held for the reads.
+  std::scoped_lock<std::shared_mutex> lock(stripe.latch_);
+  size_t home = HomeOf(stripe, page_id);
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    size_t target = (home + i) % partitions_.size();
+    TryFetchStatus status;
+    Page *page = partitions_[target]->TryFetchPage(page_id, &status);
+    if (status == TryFetchStatus::ReadFailed) {
+      return nullptr;
+    }
+    if (page == nullptr) {
+      continue;
+    }
+    if (target != home) {
+      // The old home may still have a compressed copy, which would be stale once the page changes here.
+      if (CompressedPageCache *cache = partitions_[home]->GetCompressedCache(); cache != nullptr) {
+        cache->Erase(page_id);
+      }
+      if (target == static_cast<size_t>(page_id) % partitions_.size()) {
+        stripe.homes_.erase(page_id);
+      } else {
+        stripe.homes_[page_id] = target;
+      }
+      remote_fetches_++;
+    }
+    *partition = partitions_[target].get();
+    return page;
+  }
+  return nullptr;
+}
+
+auto NumaBufferPoolManager::PartitionOfFrame(const Page *page) -> BufferPoolManager * {
+  for (auto &partition : partitions_) {
+    if (partition->OwnsFrame(page)) {
+      return partition.get();
+    }
+  }
+  UNREACHABLE("frame does not belong to any partition");
+}
+
+auto NumaBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  BufferPoolManager *partition;
+  return FetchRouted(page_id, access_type, &partition);
+}
+
+auto NumaBufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
+  BufferPoolManager *partition;
+  Page *page = FetchRouted(page_id, AccessType::Unknown, &partition);
+  return {partition, page};
+}
+
+auto NumaBufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
+  BufferPoolManager *partition;
+  Page *page = FetchRouted(page_id, AccessType::Unknown, &partition);
+  if (page != nullptr) {
+    page->RLatch();
+  }
+  return {partition, page};
+}
+
+auto NumaBufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+  BufferPoolManager *partition;
+  Page *page = FetchRouted(page_id, AccessType::Unknown, &partition);
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return {partition, page};
+}
+
+auto NumaBufferPoolManager::TryFetchPageRead(page_id_t page_id, TryFetchStatus *status) -> ReadPageGuard {
+  RouteStripe &stripe = StripeOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+  return partitions_[HomeOf(stripe, page_id)]->TryFetchPageRead(page_id, status);
+}
+
+auto NumaBufferPoolManager::TryFetchPageWrite(page_id_t page_id, TryFetchStatus *status) -> WritePageGuard {
+  RouteStripe &stripe = StripeOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+  return partitions_[HomeOf(stripe, page_id)]->TryFetchPageWrite(page_id, status);
+}
+
+auto NumaBufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+  BufferPoolManager *partition;
+  Page *page = FetchRouted(page_id, AccessType::Unknown, &partition);
+  return {partition, page};
+}
+
+auto NumaBufferPoolManager::FetchPageSnapshot(page_id_t page_id) -> PageSnapshot {
+  // Pin the page first so that it is resident in its home, where the snapshot then finds it.
+  BufferPoolManager *partition;
+  if (FetchRouted(page_id, AccessType::Unknown, &partition) == nullptr) {
+    return {};
+  }
+  PageSnapshot snapshot = partition->FetchPageSnapshot(page_id);
+  partition->UnpinPage(page_id, false);
+  return snapshot;
+}
+
+auto NumaBufferPoolManager::FetchPage(Swip *swip, AccessType access_type) -> Page * {
+  uint64_t word;
+  while (true) {
+    word = swip->word_.load(std::memory_order_acquire);
+    if (!Swip::IsSwizzled(word)) {
+      break;
+    }
+    // The partition refuses the swip if it was unswizzled (or moved to another partition) in the meantime.
+    if (Page *page = PartitionOfFrame(Swip::FrameOf(word))->FetchSwizzledPage(swip); page != nullptr) {
+      return page;
+    }
+  }
+
+  page_id_t page_id = Swip::PageIdOf(word);
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  // Make the page resident first, moving it if needed. With the page pinned, the home partition finds it and
+  // swizzles the swip into its frame.
+  BufferPoolManager *partition;
+  if (FetchRouted(page_id, access_type, &partition) == nullptr) {
+    return nullptr;
+  }
+  Page *page = partition->FetchPage(swip, access_type);
+  partition->UnpinPage(page_id, false);
+  return page;
+}
+
+auto NumaBufferPoolManager::FetchPageBasic(Swip *swip) -> BasicPageGuard {
+  Page *page = FetchPage(swip);
+  return {page == nullptr ? nullptr : PartitionOfFrame(page), page};
+}
+
+auto NumaBufferPoolManager::FetchPageRead(Swip *swip) -> ReadPageGuard {
+  Page *page = FetchPage(swip);
+  if (page == nullptr) {
+    return {nullptr, nullptr};
+  }
+  page->RLatch();
+  return {PartitionOfFrame(page), page};
+}
+
+auto NumaBufferPoolManager::FetchPageWrite(Swip *swip) -> WritePageGuard {
+  Page *page = FetchPage(swip);
+  if (page == nullptr) {
+    return {nullptr, nullptr};
+  }
+  page->WLatch();
+  return {PartitionOfFrame(page), page};
+}
+
+void NumaBufferPoolManager::ReleaseSwip(Swip *swip) {
+  uint64_t word = swip->word_.load(std::memory_order_acquire);
+  while (Swip::IsSwizzled(word)) {
+    PartitionOfFrame(Swip::FrameOf(word))->ReleaseSwip(swip);
+    word = swip->word_.load(std::memory_order_acquire);
+  }
+}
+
+auto NumaBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  return PartitionOf(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+auto NumaBufferPoolManager::FlushPage(page_id_t page_id) -> bool { return PartitionOf(page_id)->FlushPage(page_id); }
+
+void NumaBufferPoolManager::FlushAllPages() {
+  for (auto &partition : partitions_) {
+    partition->FlushAllPages();
+  }
+}
+
+auto NumaBufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  RouteStripe &stripe = StripeOf(page_id);
+  std::scoped_lock<std::shared_mutex> lock(stripe.latch_);
+  if (!partitions_[HomeOf(stripe, page_id)]->DeletePage(page_id)) {
+    return false;
+  }
+  stripe.homes_.erase(page_id);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,144 @@
+#include "buffer/page_access_benchmark.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>  // NOLINT
+
+#include "buffer/mmap_page_provider.h"
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+/** How many accesses a thread makes between two checks of the stop flag. */
+constexpr size_t OPS_PER_CHECK = 64;
+
+/** The word of a page the accesses read and write, behind the page header. */
+constexpr size_t PAYLOAD_WORD = 2;
+
+auto WorkloadName(PageAccessWorkload workload) -> const char * {
+  switch (workload) {
+    case PageAccessWorkload::ReadHeavy:
+      return "read-heavy";
+    case PageAccessWorkload::Mixed:
+      return "mixed";
+    case PageAccessWorkload::PinOnly:
+      return "pin-only";
+  }
+  return "unknown";
+}
+
+/** @return how many of 100 accesses take a write guard */
+auto WritesPer100(PageAccessWorkload workload) -> uint64_t {
+  return workload == PageAccessWorkload::Mixed ? 50 : 5;
+}
+
+}  // namespace
+
+auto PageAccessBenchmarkResult::OpsPerSecond() const -> double {
+  double seconds = std::chrono::duration<double>(elapsed_).count();
+  return seconds > 0 ? static_cast<double>(ops_) / seconds : 0;
+}
+
+auto PageAccessBenchmarkResult::ToString() const -> std::string {
+  return fmt::format("{} on {} {}pages, {} threads: {:.0f} ops/s", WorkloadName(options_.workload_),
+                     options_.num_pages_, options_.private_pages_ ? "private " : "", options_.num_threads_,
+                     OpsPerSecond());
+}
+
+template <class PageProvider>
+auto PageAccessBenchmark::Run(PageProvider *bpm, const PageAccessBenchmarkOptions &options)
+    -> PageAccessBenchmarkResult {
+  std::vector<page_id_t> page_ids(options.num_pages_);
+  for (auto &page_id : page_ids) {
+    if (!bpm->NewPageGuarded(&page_id).IsValid()) {
+      throw Exception("buffer pool too small to create the benchmark pages");
+    }
+  }
+  if (options.private_pages_ && options.num_pages_ < options.num_threads_) {
+    throw Exception("private pages need at least one page per thread");
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<size_t> thread_ops(options.num_threads_);
+  std::vector<std::thread> threads;
+  uint64_t writes_per_100 = WritesPer100(options.workload_);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options.num_threads_; i++) {
+    threads.emplace_back([&, i] {
+      // xorshift64, cheap enough not to show up next to a page access.
+      uint64_t rng = (options.seed_ + i) * 0x9e3779b97f4a7c15ULL + 1;
+      // Consecutive pages sit in consecutive frames, so interleaving the slices puts threads on neighbouring frames.
+      size_t first_page = options.private_pages_ ? i : 0;
+      size_t page_stride = options.private_pages_ ? options.num_threads_ : 1;
+      size_t num_pages = (page_ids.size() - first_page + page_stride - 1) / page_stride;
+      bool pin_only = options.workload_ == PageAccessWorkload::PinOnly;
+      size_t ops = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (size_t k = 0; k < OPS_PER_CHECK; k++) {
+          rng ^= rng << 13;
+          rng ^= rng >> 7;
+          rng ^= rng << 17;
+          page_id_t page_id = page_ids[first_page + (rng >> 8) % num_pages * page_stride];
+          if (pin_only) {
+            BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+          } else if (rng % 100 < writes_per_100) {
+            WritePageGuard guard = bpm->FetchPageWrite(page_id);
+            guard.AsMut<uint64_t>()[PAYLOAD_WORD]++;
+          } else {
+            ReadPageGuard guard = bpm->FetchPageRead(page_id);
+            volatile uint64_t word = guard.As<uint64_t>()[PAYLOAD_WORD];
+            (void)word;
+          }
+        }
+        ops += OPS_PER_CHECK;
+      }
+      thread_ops[i] = ops;
+    });
+  }
+  std::this_thread::sleep_for(options.duration_);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  PageAccessBenchmarkResult result;
+  result.options_ = options;
+  result.elapsed_ = std::chrono::steady_clock::now() - start;
+  for (size_t ops : thread_ops) {
+    result.ops_ += ops;
+  }
+  return result;
+}
+
+template auto PageAccessBenchmark::Run(BufferPoolManager *bpm, const PageAccessBenchmarkOptions &options)
+    -> PageAccessBenchmarkResult;
+template auto PageAccessBenchmark::Run(MmapPageProvider *bpm, const PageAccessBenchmarkOptions &options)
+    -> PageAccessBenchmarkResult;
+
+auto PageAccessBenchmark::ComparePageProviders(const std::string &db_file, size_t pool_size,
+                                               const PageAccessBenchmarkOptions &options)
+    -> std::pair<PageAccessBenchmarkResult, PageAccessBenchmarkResult> {
+  std::pair<PageAccessBenchmarkResult, PageAccessBenchmarkResult> results;
+  std::remove(db_file.c_str());
+  {
+    DiskManager disk_manager(db_file);
+    {
+      BufferPoolManager bpm(pool_size, &disk_manager);
+      results.first = Run(&bpm, options);
+    }
+    disk_manager.ShutDown();
+  }
+  std::remove(db_file.c_str());
+  {
+    MmapPageProvider provider(db_file, options.num_pages_);
+    results.second = Run(&provider, options);
+  }
+  std::remove(db_file.c_str());
+  return results;
+}
+
+}  // namespace bustub
@@ -0,0 +1,51 @@
+#include "buffer/page_checksum_table.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void PageChecksumTable::Record(page_id_t page_id, uint32_t checksum) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto block_id = static_cast<page_id_t>(page_id / ENTRIES_PER_BLOCK);
+  Entry *block = GetBlock(block_id);
+  Entry &entry = block[page_id % ENTRIES_PER_BLOCK];
+  if (entry.num_recorded_ > 0 && entry.current_ == checksum) {
+    // Rewriting an unchanged image, the entry already covers it.
+    return;
+  }
+  entry.previous_ = entry.current_;
+  entry.current_ = checksum;
+  entry.num_recorded_ = std::min<uint32_t>(entry.num_recorded_ + 1, 2);
+  if (disk_manager_ != nullptr) {
+    dirty_blocks_.insert(block_id);
+  }
+}
+
+void PageChecksumTable::Flush() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (page_id_t block_id : dirty_blocks_) {
+    disk_manager_->WritePage(block_id, reinterpret_cast<const char *>(blocks_[block_id].get()));
+  }
+  dirty_blocks_.clear();
+}
+
+auto PageChecksumTable::Verify(page_id_t page_id, uint32_t checksum) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  const Entry &entry = GetBlock(static_cast<page_id_t>(page_id / ENTRIES_PER_BLOCK))[page_id % ENTRIES_PER_BLOCK];
+  return entry.num_recorded_ == 0 || entry.current_ == checksum ||
+         (entry.num_recorded_ > 1 && entry.previous_ == checksum);
+}
+
+auto PageChecksumTable::GetBlock(page_id_t block_id) -> Entry * {
+  auto &block = blocks_[block_id];
+  if (block == nullptr) {
+    // Blocks past the end of the table read as zeroes, i.e. pages without a recorded checksum.
+    block = std::make_unique<Entry[]>(ENTRIES_PER_BLOCK);
+    if (disk_manager_ != nullptr) {
+      disk_manager_->ReadPage(block_id, reinterpret_cast<char *>(block.get()));
+    }
+  }
+  return block.get();
+}
+
+}  // namespace bustub
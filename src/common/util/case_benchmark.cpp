@@ -0,0 +1,90 @@
+#include "common/util/case_benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "common/util/case_util.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+namespace {
+
+/** How many conversions run between two reads of the clock. */
+constexpr size_t CONVERSIONS_PER_CHECK = 64;
+
+/**
+ * @brief Run `convert(upper)` back to back for the given time, alternating upper and lower case.
+ * @return the average time of one call, in nanoseconds
+ */
+template <class Convert>
+auto TimeConversions(std::chrono::milliseconds duration, Convert convert) -> double {
+  size_t count = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + duration;
+  auto now = start;
+  while (now < deadline) {
+    for (size_t i = 0; i < CONVERSIONS_PER_CHECK; i++) {
+      convert(i % 2 == 0);
+    }
+    count += CONVERSIONS_PER_CHECK;
+    now = std::chrono::steady_clock::now();
+  }
+  return std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(count);
+}
+
+}  // namespace
+
+auto CaseBenchmarkResult::Speedup() const -> double { return kernel_ns_ > 0 ? baseline_ns_ / kernel_ns_ : 0; }
+
+auto CaseBenchmarkResult::ToString() const -> std::string {
+  return fmt::format("{} {}bytes: {:.1f} ns vs {:.1f} ns with std::transform ({:.1f}x)", options_.length_,
+                     options_.non_ascii_ ? "non-ASCII " : "", kernel_ns_, baseline_ns_, Speedup());
+}
+
+auto CaseBenchmark::Run(const CaseBenchmarkOptions &options) -> CaseBenchmarkResult {
+  std::string src(options.length_, ' ');
+  for (size_t i = 0; i < src.size(); i++) {
+    // Letters of both cases with some digits and punctuation in between, like typical text.
+    static constexpr char TEXT[] = "The Quick Brown Fox, 42 Jumps over the LAZY dog. ";
+    src[i] = TEXT[i % (sizeof(TEXT) - 1)];
+  }
+  if (options.non_ascii_) {
+    for (size_t i = 0; i + 1 < src.size(); i += 64) {
+      src[i] = '\xc3';
+      src[i + 1] = '\xa9';
+    }
+  }
+  std::string dst(src.size(), '\0');
+  // Read back one byte of every conversion, so the compiler cannot drop them.
+  volatile char sink;
+
+  CaseBenchmarkResult result;
+  result.options_ = options;
+  result.kernel_ns_ = TimeConversions(options.duration_, [&](bool upper) {
+    if (upper) {
+      CaseUtil::ToUpper(src.data(), src.size(), dst.data());
+    } else {
+      CaseUtil::ToLower(src.data(), src.size(), dst.data());
+    }
+    sink = dst.empty() ? '\0' : dst.back();
+  });
+  result.baseline_ns_ = TimeConversions(options.duration_, [&](bool upper) {
+    std::transform(src.begin(), src.end(), dst.begin(), upper ? ::toupper : ::tolower);
+    sink = dst.empty() ? '\0' : dst.back();
+  });
+  (void)sink;
+  return result;
+}
+
+auto CaseBenchmark::RunLengths(const std::vector<size_t> &lengths, CaseBenchmarkOptions options)
+    -> std::vector<CaseBenchmarkResult> {
+  std::vector<CaseBenchmarkResult> results;
+  for (size_t length : lengths) {
+    options.length_ = length;
+    results.push_back(Run(options));
+  }
+  return results;
+}
+
+}  // namespace bustub
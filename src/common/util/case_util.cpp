@@ -0,0 +1,118 @@
+#include "common/util/case_util.h"
+
+#include <cctype>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Flipping this bit switches an ASCII letter between upper and lower case. */
+constexpr unsigned char CASE_BIT = 0x20;
+
+/** Converts the characters in [first, first + 26) with CASE_BIT, and non-ASCII characters with `convert`. */
+using CaseKernel = void (*)(const char *src, size_t len, char *dst, char first, int (*convert)(int));
+
+inline void ConvertScalar(const char *src, size_t len, char *dst, char first, int (*convert)(int)) {
+  for (size_t i = 0; i < len; i++) {
+    auto c = static_cast<unsigned char>(src[i]);
+    if (c < 0x80) {
+      dst[i] = static_cast<char>(static_cast<unsigned char>(c - first) < 26 ? c ^ CASE_BIT : c);
+    } else {
+      dst[i] = static_cast<char>(convert(c));
+    }
+  }
+}
+
+#if defined(__x86_64__)
+
+// The kernels bias the bytes by 0x80 - first, which moves the letters to convert to the bottom of the signed range, so
+// one signed comparison finds them. Bytes with the top bit set are never in range after the bias; blocks holding them
+// are handed to ConvertScalar() as a whole anyway, so that a locale's conversion of them is kept.
+
+void ConvertSse2(const char *src, size_t len, char *dst, char first, int (*convert)(int)) {
+  const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80 - first));
+  const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+  const __m128i flip = _mm_set1_epi8(static_cast<char>(CASE_BIT));
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    if (_mm_movemask_epi8(v) != 0) {
+      ConvertScalar(src + i, 16, dst + i, first, convert);
+      continue;
+    }
+    __m128i in_range = _mm_cmplt_epi8(_mm_add_epi8(v, bias), limit);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(v, _mm_and_si128(in_range, flip)));
+  }
+  ConvertScalar(src + i, len - i, dst + i, first, convert);
+}
+
+__attribute__((target("avx2"))) void ConvertAvx2(const char *src, size_t len, char *dst, char first,
+                                                 int (*convert)(int)) {
+  const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80 - first));
+  const __m256i limit = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+  const __m256i flip = _mm256_set1_epi8(static_cast<char>(CASE_BIT));
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    if (_mm256_movemask_epi8(v) != 0) {
+      ConvertScalar(src + i, 32, dst + i, first, convert);
+      continue;
+    }
+    __m256i in_range = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(v, bias));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(v, _mm256_and_si256(in_range, flip)));
+  }
+  // The SSE2 kernel takes the last 16 bytes of a tail.
+  ConvertSse2(src + i, len - i, dst + i, first, convert);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void ConvertAvx512(const char *src, size_t len, char *dst, char first,
+                                                               int (*convert)(int)) {
+  const __m512i bias = _mm512_set1_epi8(static_cast<char>(0x80 - first));
+  const __m512i limit = _mm512_set1_epi8(static_cast<char>(-128 + 26));
+  const __m512i flip = _mm512_set1_epi8(static_cast<char>(CASE_BIT));
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512i v = _mm512_loadu_si512(src + i);
+    if (_mm512_movepi8_mask(v) != 0) {
+      ConvertScalar(src + i, 64, dst + i, first, convert);
+      continue;
+    }
+    __mmask64 in_range = _mm512_cmplt_epi8_mask(_mm512_add_epi8(v, bias), limit);
+    _mm512_storeu_si512(dst + i, _mm512_xor_si512(v, _mm512_maskz_mov_epi8(in_range, flip)));
+  }
+  ConvertAvx2(src + i, len - i, dst + i, first, convert);
+}
+
+auto PickKernel() -> CaseKernel {
+  if (__builtin_cpu_supports("avx512bw") != 0) {
+    return ConvertAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") != 0) {
+    return ConvertAvx2;
+  }
+  // SSE2 is part of x86-64.
+  return ConvertSse2;
+}
+
+#else
+
+auto PickKernel() -> CaseKernel { return ConvertScalar; }
+
+#endif
+
+auto Kernel() -> CaseKernel {
+  static const CaseKernel KERNEL = PickKernel();
+  return KERNEL;
+}
+
+}  // namespace
+
+void CaseUtil::ToUpper(const char *src, size_t len, char *dst) { Kernel()(src, len, dst, 'a', ::toupper); }
+
+void CaseUtil::ToLower(const char *src, size_t len, char *dst) { Kernel()(src, len, dst, 'A', ::tolower); }
+
+}  // namespace bustub
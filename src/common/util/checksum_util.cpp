@@ -0,0 +1,113 @@
+#include "common/util/checksum_util.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Reflected CRC32C polynomial. */
+constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+/** Lookup tables for slicing-by-8: table[k][b] is the CRC of byte b followed by k zero bytes. */
+struct Crc32cTables {
+  std::array<std::array<uint32_t, 256>, 8> table_;
+
+  Crc32cTables() : table_() {
+    for (uint32_t b = 0; b < 256; b++) {
+      uint32_t crc = b;
+      for (int i = 0; i < 8; i++) {
+        crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLY : 0);
+      }
+      table_[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; b++) {
+      for (size_t k = 1; k < 8; k++) {
+        table_[k][b] = (table_[k - 1][b] >> 8) ^ table_[0][table_[k - 1][b] & 0xFF];
+      }
+    }
+  }
+};
+
+auto Crc32cSoftware(const char *data, size_t len, uint32_t crc) -> uint32_t {
+  static const Crc32cTables TABLES;
+  const auto &t = TABLES.table_;
+  const auto *p = reinterpret_cast<const unsigned char *>(data);
+  crc = ~crc;
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    word ^= crc;
+    crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF] ^
+          t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+    p += 8;
+    len -= 8;
+  }
+  while (len-- > 0) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+  }
+  return ~crc;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) auto Crc32cHardware(const char *data, size_t len, uint32_t crc) -> uint32_t {
+  uint64_t crc64 = ~crc;
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    data += 8;
+    len -= 8;
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  while (len-- > 0) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*data++));
+  }
+  return ~crc32;
+}
+
+auto HasHardwareCrc32c() -> bool { return __builtin_cpu_supports("sse4.2") != 0; }
+
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+auto Crc32cHardware(const char *data, size_t len, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = __crc32cd(crc, word);
+    data += 8;
+    len -= 8;
+  }
+  while (len-- > 0) {
+    crc = __crc32cb(crc, static_cast<unsigned char>(*data++));
+  }
+  return ~crc;
+}
+
+auto HasHardwareCrc32c() -> bool { return true; }
+
+#else
+
+auto Crc32cHardware(const char *data, size_t len, uint32_t crc) -> uint32_t { return Crc32cSoftware(data, len, crc); }
+
+auto HasHardwareCrc32c() -> bool { return false; }
+
+#endif
+
+}  // namespace
+
+auto ChecksumUtil::Crc32c(const char *data, size_t len, uint32_t crc) -> uint32_t {
+  static const bool HARDWARE = HasHardwareCrc32c();
+  return HARDWARE ? Crc32cHardware(data, len, crc) : Crc32cSoftware(data, len, crc);
+}
+
+}  // namespace bustub
@@ -0,0 +1,183 @@
+#include "common/util/compression_util.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+/** The last bytes of a block are always emitted as literals, as the format requires. */
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+
+inline auto Read32(const unsigned char *p) -> uint32_t {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline auto Hash(uint32_t v) -> uint32_t { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append an LZ4 length continuation (the part that did not fit in the token nibble). */
+inline auto WriteLength(unsigned char *op, const unsigned char *oend, size_t len) -> unsigned char * {
+  while (len >= 255) {
+    if (op >= oend) {
+      return nullptr;
+    }
+    *op++ = 255;
+    len -= 255;
+  }
+  if (op >= oend) {
+    return nullptr;
+  }
+  *op++ = static_cast<unsigned char>(len);
+  return op;
+}
+
+/** Emit one sequence: token, literals and, unless this is the last sequence, the match. */
+auto WriteSequence(unsigned char *op, const unsigned char *oend, const unsigned char *literals, size_t literal_len,
+                   size_t offset, size_t match_len) -> unsigned char * {
+  if (op >= oend) {
+    return nullptr;
+  }
+  unsigned char *token = op++;
+  *token = static_cast<unsigned char>((literal_len >= 15 ? 15 : literal_len) << 4);
+  if (literal_len >= 15 && (op = WriteLength(op, oend, literal_len - 15)) == nullptr) {
+    return nullptr;
+  }
+  if (static_cast<size_t>(oend - op) < literal_len) {
+    return nullptr;
+  }
+  memcpy(op, literals, literal_len);
+  op += literal_len;
+  if (match_len == 0) {
+    return op;
+  }
+
+  if (oend - op < 2) {
+    return nullptr;
+  }
+  *op++ = static_cast<unsigned char>(offset & 0xFF);
+  *op++ = static_cast<unsigned char>(offset >> 8);
+  size_t match_code = match_len - MIN_MATCH;
+  *token |= static_cast<unsigned char>(match_code >= 15 ? 15 : match_code);
+  if (match_code >= 15) {
+    op = WriteLength(op, oend, match_code - 15);
+  }
+  return op;
+}
+
+/** Read an LZ4 length continuation. @return false if the input ends prematurely */
+inline auto ReadLength(const unsigned char **ip, const unsigned char *iend, size_t *len) -> bool {
+  unsigned char b;
+  do {
+    if (*ip >= iend) {
+      return false;
+    }
+    b = *(*ip)++;
+    *len += b;
+  } while (b == 255);
+  return true;
+}
+
+}  // namespace
+
+auto CompressionUtil::Compress(const char *src, size_t len, char *dst, size_t capacity) -> size_t {
+  const auto *ip = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *base = ip;
+  const unsigned char *iend = ip + len;
+  const unsigned char *anchor = ip;
+  auto *op = reinterpret_cast<unsigned char *>(dst);
+  const unsigned char *oend = op + capacity;
+
+  if (len > MIN_MATCH + LAST_LITERALS) {
+    std::array<uint32_t, 1U << HASH_BITS> table{};
+    const unsigned char *match_limit = iend - LAST_LITERALS;
+    const unsigned char *search_limit = match_limit - MIN_MATCH;
+    ip++;
+    while (ip < search_limit) {
+      uint32_t seq = Read32(ip);
+      uint32_t h = Hash(seq);
+      const unsigned char *ref = base + table[h];
+      table[h] = static_cast<uint32_t>(ip - base);
+      if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != seq) {
+        ip++;
+        continue;
+      }
+
+      // Extend the match backwards over pending literals, then forwards.
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      size_t match_len = MIN_MATCH;
+      while (ip + match_len < match_limit && ip[match_len] == ref[match_len]) {
+        match_len++;
+      }
+      op = WriteSequence(op, oend, anchor, ip - anchor, ip - ref, match_len);
+      if (op == nullptr) {
+        return 0;
+      }
+      ip += match_len;
+      anchor = ip;
+    }
+  }
+
+  op = WriteSequence(op, oend, anchor, iend - anchor, 0, 0);
+  if (op == nullptr) {
+    return 0;
+  }
+  return op - reinterpret_cast<unsigned char *>(dst);
+}
+
+auto CompressionUtil::Decompress(const char *src, size_t len, char *dst, size_t capacity) -> size_t {
+  const auto *ip = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *iend = ip + len;
+  auto *op = reinterpret_cast<unsigned char *>(dst);
+  auto *obase = op;
+  const unsigned char *oend = op + capacity;
+
+  while (ip < iend) {
+    unsigned char token = *ip++;
+    size_t literal_len = token >> 4;
+    if (literal_len == 15 && !ReadLength(&ip, iend, &literal_len)) {
+      return 0;
+    }
+    if (static_cast<size_t>(iend - ip) < literal_len || static_cast<size_t>(oend - op) < literal_len) {
+      return 0;
+    }
+    memcpy(op, ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+    if (ip == iend) {
+      break;  // the last sequence has no match
+    }
+
+    if (iend - ip < 2) {
+      return 0;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_len = token & 0xF;
+    if (match_len == 15 && !ReadLength(&ip, iend, &match_len)) {
+      return 0;
+    }
+    match_len += MIN_MATCH;
+    if (offset == 0 || static_cast<size_t>(op - obase) < offset || static_cast<size_t>(oend - op) < match_len) {
+      return 0;
+    }
+    // Matches may overlap their own output, so copy byte by byte.
+    const unsigned char *ref = op - offset;
+    for (size_t i = 0; i < match_len; i++) {
+      op[i] = ref[i];
+    }
+    op += match_len;
+  }
+  return op - obase;
+}
+
+}  // namespace bustub
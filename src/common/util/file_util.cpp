@@ -0,0 +1,87 @@
+#include "common/util/file_util.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+void FileUtil::WriteAll(int fd, const char *data, size_t size, const std::string &file) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = write(fd, data + written, size - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      throw Exception(fmt::format("I/O error while writing {}: {}", file, strerror(errno)));
+    }
+    written += static_cast<size_t>(result);
+  }
+}
+
+void FileUtil::WriteAllAt(int fd, const char *data, size_t size, uint64_t offset, const std::string &file) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = pwrite(fd, data + written, size - written, static_cast<off_t>(offset + written));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      throw Exception(fmt::format("I/O error while writing {}: {}", file, strerror(errno)));
+    }
+    written += static_cast<size_t>(result);
+  }
+}
+
+void FileUtil::Sync(int fd, const std::string &file) {
+  if (fsync(fd) != 0) {
+    throw Exception(fmt::format("cannot sync {}: {}", file, strerror(errno)));
+  }
+}
+
+void FileUtil::SyncParentDirectory(const std::string &file) {
+  size_t slash = file.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : file.substr(0, std::max<size_t>(slash, 1));
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    throw Exception(fmt::format("cannot open directory {}: {}", dir, strerror(errno)));
+  }
+  int result = fsync(fd);
+  int error = errno;
+  close(fd);
+  if (result != 0) {
+    throw Exception(fmt::format("cannot sync directory {}: {}", dir, strerror(error)));
+  }
+}
+
+void FileUtil::ReplaceFile(const std::string &file, const std::string &data) {
+  // The new contents have to be durable before the rename, or the rename could reach disk first and leave an empty
+  // file behind.
+  std::string tmp_file = file + ".tmp";
+  int fd = open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw Exception(fmt::format("cannot open {}: {}", tmp_file, strerror(errno)));
+  }
+  try {
+    WriteAll(fd, data.data(), data.size(), tmp_file);
+    Sync(fd, tmp_file);
+  } catch (const Exception &) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+  if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+    throw Exception(fmt::format("cannot replace {}: {}", file, strerror(errno)));
+  }
+  SyncParentDirectory(file);
+}
+
+}  // namespace bustub
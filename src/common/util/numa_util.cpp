@@ -0,0 +1,117 @@
+#include "common/util/numa_util.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** NUMA topology as read from sysfs. */
+struct NumaTopology {
+  /** CPUs of each node. */
+  std::vector<std::vector<int>> node_cpus_;
+  /** Node of each CPU. */
+  std::vector<size_t> cpu_node_;
+
+  NumaTopology() {
+    // Node ids can have gaps, and some nodes have memory but no CPUs (e.g. CXL or HBM nodes). Only nodes with CPUs
+    // can run threads, so those are the nodes we report, numbered densely from 0.
+    for (int sysfs_node : ParseCpuList(ReadLine("/sys/devices/system/node/online"))) {
+      std::vector<int> cpus =
+          ParseCpuList(ReadLine("/sys/devices/system/node/node" + std::to_string(sysfs_node) + "/cpulist"));
+      if (cpus.empty()) {
+        continue;
+      }
+      for (int cpu : cpus) {
+        if (cpu_node_.size() <= static_cast<size_t>(cpu)) {
+          cpu_node_.resize(cpu + 1, 0);
+        }
+        cpu_node_[cpu] = node_cpus_.size();
+      }
+      node_cpus_.push_back(std::move(cpus));
+    }
+    if (node_cpus_.empty()) {
+      node_cpus_.emplace_back();
+    }
+  }
+
+  /** @return the first line of a file, or an empty string if it cannot be read */
+  static auto ReadLine(const std::string &file) -> std::string {
+    std::ifstream in(file);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+      return "";
+    }
+    return line;
+  }
+
+  /** Parse a sysfs cpu (or node) list such as "0-3,8-11". */
+  static auto ParseCpuList(const std::string &cpulist) -> std::vector<int> {
+    std::vector<int> cpus;
+    std::stringstream ss(cpulist);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+      if (range.empty()) {
+        continue;
+      }
+      auto dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; cpu++) {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+};
+
+auto GetTopology() -> const NumaTopology & {
+  static const NumaTopology TOPOLOGY;
+  return TOPOLOGY;
+}
+
+}  // namespace
+
+auto NumaUtil::NumNodes() -> size_t { return GetTopology().node_cpus_.size(); }
+
+auto NumaUtil::CurrentNode() -> size_t {
+#ifdef __linux__
+  const auto &topology = GetTopology();
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < topology.cpu_node_.size()) {
+    return topology.cpu_node_[cpu];
+  }
+#endif
+  return 0;
+}
+
+auto NumaUtil::NodeCpus(size_t node) -> std::vector<int> {
+  const auto &topology = GetTopology();
+  return node < topology.node_cpus_.size() ? topology.node_cpus_[node] : std::vector<int>{};
+}
+
+auto NumaUtil::BindCurrentThread(size_t node) -> bool {
+#ifdef __linux__
+  std::vector<int> cpus = NodeCpus(node);
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
@@ -0,0 +1,150 @@
+#include "execution/function_registry.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/util/case_util.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+#include "type/type.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return "first", "second", ... for argument `index` */
+auto ArgOrdinal(size_t index) -> std::string {
+  static const char *const ORDINALS[] = {"first", "second", "third"};
+  return index < 3 ? ORDINALS[index] : fmt::format("{}th", index + 1);
+}
+
+/** @return the SQL name of a type in lower case, as used in error messages */
+auto TypeName(TypeId type) -> std::string {
+  std::string name = Type::TypeIdToString(type);
+  CaseUtil::ToLower(name.data(), name.size(), name.data());
+  return name;
+}
+
+/** @return the rank of an integer type, wider types ranking higher, or -1 for other types */
+auto IntegerRank(TypeId type) -> int {
+  switch (type) {
+    case TypeId::TINYINT:
+      return 0;
+    case TypeId::SMALLINT:
+      return 1;
+    case TypeId::INTEGER:
+      return 2;
+    case TypeId::BIGINT:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+/** @return the cost of passing a `from` argument where `to` is taken, -1 if it does not convert */
+auto ConversionCost(TypeId from, TypeId to) -> int {
+  if (from == to) {
+    return 0;
+  }
+  int from_rank = IntegerRank(from);
+  int to_rank = IntegerRank(to);
+  return from_rank >= 0 && to_rank > from_rank ? to_rank - from_rank : -1;
+}
+
+auto AcceptsArgCount(const ScalarFunction &function, size_t num_args) -> bool {
+  return function.variadic_ ? num_args >= function.arg_types_.size() : num_args == function.arg_types_.size();
+}
+
+}  // namespace
+
+auto FunctionRegistry::FunctionKeyHash::operator()(const FunctionKey &key) const -> size_t {
+  size_t hash = std::hash<std::string>()(key.name_);
+  for (TypeId type : key.arg_types_) {
+    hash = hash * 31 + static_cast<size_t>(type);
+  }
+  return hash;
+}
+
+auto FunctionRegistry::Instance() -> FunctionRegistry & {
+  static FunctionRegistry instance;
+  return instance;
+}
+
+FunctionRegistry::FunctionRegistry() { RegisterStringFunctions(this); }
+
+void FunctionRegistry::Register(ScalarFunction function) {
+  std::scoped_lock<std::shared_mutex> lock(latch_);
+  FunctionKey key{function.name_, function.arg_types_};
+  if (functions_.count(key) > 0) {
+    throw Exception(fmt::format("function {} with {} args is already registered", function.name_,
+                                function.arg_types_.size()));
+  }
+  auto entry = std::make_unique<ScalarFunction>(std::move(function));
+  overloads_[entry->name_].push_back(entry.get());
+  functions_.emplace(std::move(key), std::move(entry));
+}
+
+auto FunctionRegistry::Lookup(const std::string &name, const std::vector<TypeId> &arg_types) const
+    -> const ScalarFunction * {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  auto it = functions_.find(FunctionKey{name, arg_types});
+  return it == functions_.end() ? nullptr : it->second.get();
+}
+
+auto FunctionRegistry::Resolve(const std::string &name, const std::vector<TypeId> &arg_types) const
+    -> const ScalarFunction & {
+  if (const ScalarFunction *function = Lookup(name, arg_types); function != nullptr) {
+    return *function;
+  }
+
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  auto it = overloads_.find(name);
+  if (it == overloads_.end()) {
+    throw Exception(fmt::format("func call {} not supported in planner yet", name));
+  }
+  const ScalarFunction *best = nullptr;
+  int best_cost = 0;
+  for (const ScalarFunction *overload : it->second) {
+    if (!AcceptsArgCount(*overload, arg_types.size())) {
+      continue;
+    }
+    int cost = 0;
+    for (size_t i = 0; i < arg_types.size() && cost >= 0; i++) {
+      int arg_cost = ConversionCost(arg_types[i], overload->ArgType(i));
+      cost = arg_cost < 0 ? -1 : cost + arg_cost;
+    }
+    if (cost >= 0 && (best == nullptr || cost < best_cost)) {
+      best = overload;
+      best_cost = cost;
+    }
+  }
+  if (best != nullptr) {
+    return *best;
+  }
+
+  // No overload fits, explain why.
+  std::vector<std::pair<size_t, bool>> arg_counts;
+  for (const ScalarFunction *overload : it->second) {
+    if (!AcceptsArgCount(*overload, arg_types.size())) {
+      arg_counts.emplace_back(overload->arg_types_.size(), overload->variadic_);
+      continue;
+    }
+    for (size_t i = 0; i < arg_types.size(); i++) {
+      if (ConversionCost(arg_types[i], overload->ArgType(i)) < 0) {
+        throw Exception(fmt::format("expect the {} arg to be {}", ArgOrdinal(i), TypeName(overload->ArgType(i))));
+      }
+    }
+  }
+  std::sort(arg_counts.begin(), arg_counts.end());
+  arg_counts.erase(std::unique(arg_counts.begin(), arg_counts.end()), arg_counts.end());
+  std::vector<std::string> expected;
+  for (auto [count, variadic] : arg_counts) {
+    expected.push_back(variadic ? fmt::format("at least {}", count) : std::to_string(count));
+  }
+  throw Exception(fmt::format("arg number should be {}, got {}", fmt::join(expected, " or "), arg_types.size()));
+}
+
+}  // namespace bustub
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/util/case_util.h"
+#include "execution/function_registry.h"
+#include "fmt/format.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// Lengths and positions count bytes, and case conversion only maps ASCII letters, like upper() and lower() always did.
+
+namespace {
+
+auto StringArg(const Value &value) -> std::string_view { return value.GetAs<char *>(); }
+
+/**
+ * Convert the case of a string into a buffer that is reused by the thread, so that the only allocation is the copy
+ * the result Value owns.
+ */
+auto ConvertCase(std::string_view str, void (*convert)(const char *, size_t, char *)) -> Value {
+  thread_local std::string buffer;
+  // VARCHAR values carry their terminating null byte.
+  buffer.resize(str.size() + 1);
+  convert(str.data(), str.size(), buffer.data());
+  buffer[str.size()] = '\0';
+  return ValueFactory::GetVarcharValue(buffer.data(), static_cast<uint32_t>(str.size() + 1), true);
+}
+
+/** Like ConvertCase(), but the result is written into the arena and not owned by the value. */
+auto ConvertCase(std::string_view str, void (*convert)(const char *, size_t, char *), Arena *arena) -> Value {
+  char *res = arena->Allocate(str.size() + 1);
+  convert(str.data(), str.size(), res);
+  res[str.size()] = '\0';
+  return ValueFactory::GetVarcharValue(res, static_cast<uint32_t>(str.size() + 1), false);
+}
+
+auto Upper(const std::vector<Value> &args) -> Value { return ConvertCase(StringArg(args[0]), CaseUtil::ToUpper); }
+
+auto Lower(const std::vector<Value> &args) -> Value { return ConvertCase(StringArg(args[0]), CaseUtil::ToLower); }
+
+auto UpperArena(const std::vector<Value> &args, Arena *arena) -> Value {
+  return ConvertCase(StringArg(args[0]), CaseUtil::ToUpper, arena);
+}
+
+auto LowerArena(const std::vector<Value> &args, Arena *arena) -> Value {
+  return ConvertCase(StringArg(args[0]), CaseUtil::ToLower, arena);
+}
+
+void UpperBatch(const StringBatch &input, StringBatch *output) {
+  CaseUtil::ToUpper(input.Data(), input.DataSize(), output->ResizeLike(input));
+}
+
+void LowerBatch(const StringBatch &input, StringBatch *output) {
+  CaseUtil::ToLower(input.Data(), input.DataSize(), output->ResizeLike(input));
+}
+
+auto Length(const std::vector<Value> &args) -> Value {
+  return ValueFactory::GetIntegerValue(static_cast<int32_t>(StringArg(args[0]).size()));
+}
+
+/** substring(str, start[, count]) takes `count` bytes from the 1-based `start`, clipped to the string. */
+auto Substring(const std::vector<Value> &args) -> Value {
+  std::string_view str = StringArg(args[0]);
+  int64_t begin = args[1].GetAs<int64_t>();
+  int64_t end = static_cast<int64_t>(str.size()) + 1;
+  if (args.size() == 3) {
+    int64_t count = args[2].GetAs<int64_t>();
+    if (count < 0) {
+      throw Exception(fmt::format("negative substring length {} not allowed", count));
+    }
+    // end - begin may overflow an int64_t for a very negative begin, but not an uint64_t.
+    if (begin < end && static_cast<uint64_t>(count) < static_cast<uint64_t>(end) - static_cast<uint64_t>(begin)) {
+      end = begin + count;
+    }
+  }
+  begin = std::max<int64_t>(begin, 1);
+  if (begin >= end) {
+    return ValueFactory::GetVarcharValue("");
+  }
+  return ValueFactory::GetVarcharValue(std::string(str.substr(begin - 1, end - begin)));
+}
+
+/** concat() takes one or more arguments and skips NULL ones, so it is not strict. */
+auto Concat(const std::vector<Value> &args) -> Value {
+  std::string res;
+  for (const auto &arg : args) {
+    if (!arg.IsNull()) {
+      res.append(StringArg(arg));
+    }
+  }
+  return ValueFactory::GetVarcharValue(res);
+}
+
+/** trim() strips spaces from both ends. */
+auto TrimView(std::string_view str) -> std::string_view {
+  size_t begin = str.find_first_not_of(' ');
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  return str.substr(begin, str.find_last_not_of(' ') - begin + 1);
+}
+
+auto Trim(const std::vector<Value> &args) -> Value {
+  return ValueFactory::GetVarcharValue(std::string(TrimView(StringArg(args[0]))));
+}
+
+void TrimBatch(const StringBatch &input, StringBatch *output) {
+  output->Clear();
+  output->Reserve(input.Size(), input.DataSize());
+  for (size_t i = 0; i < input.Size(); i++) {
+    if (input.IsNull(i)) {
+      output->AppendNull();
+    } else {
+      output->Append(TrimView(input.Get(i)));
+    }
+  }
+}
+
+/** replace(str, from, to) replaces every occurrence of `from`, an empty `from` matches nothing. */
+auto Replace(const std::vector<Value> &args) -> Value {
+  std::string_view str = StringArg(args[0]);
+  std::string_view from = StringArg(args[1]);
+  std::string_view to = StringArg(args[2]);
+  if (from.empty()) {
+    return ValueFactory::GetVarcharValue(std::string(str));
+  }
+  std::string res;
+  res.reserve(str.size());
+  size_t pos = 0;
+  for (size_t match = str.find(from); match != std::string_view::npos; match = str.find(from, pos)) {
+    res.append(str.substr(pos, match - pos)).append(to);
+    pos = match + from.size();
+  }
+  res.append(str.substr(pos));
+  return ValueFactory::GetVarcharValue(res);
+}
+
+auto StartsWith(const std::vector<Value> &args) -> Value {
+  std::string_view str = StringArg(args[0]);
+  std::string_view prefix = StringArg(args[1]);
+  return ValueFactory::GetBooleanValue(str.substr(0, prefix.size()) == prefix);
+}
+
+/** position(str, substr) is the 1-based position of the first occurrence of `substr`, 0 if there is none. */
+auto Position(const std::vector<Value> &args) -> Value {
+  size_t pos = StringArg(args[0]).find(StringArg(args[1]));
+  return ValueFactory::GetIntegerValue(pos == std::string_view::npos ? 0 : static_cast<int32_t>(pos) + 1);
+}
+
+}  // namespace
+
+void RegisterStringFunctions(FunctionRegistry *registry) {
+  constexpr TypeId VARCHAR = TypeId::VARCHAR;
+  constexpr TypeId INTEGER = TypeId::INTEGER;
+  constexpr TypeId BIGINT = TypeId::BIGINT;
+  registry->Register({"upper", {VARCHAR}, VARCHAR, Upper, UpperBatch, true, true, UpperArena});
+  registry->Register({"lower", {VARCHAR}, VARCHAR, Lower, LowerBatch, true, true, LowerArena});
+  registry->Register({"length", {VARCHAR}, INTEGER, Length});
+  // Narrower integer arguments are promoted to BIGINT, so one overload per arity covers all of them.
+  registry->Register({"substring", {VARCHAR, BIGINT}, VARCHAR, Substring});
+  registry->Register({"substring", {VARCHAR, BIGINT, BIGINT}, VARCHAR, Substring});
+  ScalarFunction concat{"concat", {VARCHAR}, VARCHAR, Concat, nullptr, false};
+  concat.variadic_ = true;
+  registry->Register(std::move(concat));
+  registry->Register({"trim", {VARCHAR}, VARCHAR, Trim, TrimBatch});
+  registry->Register({"replace", {VARCHAR, VARCHAR, VARCHAR}, VARCHAR, Replace});
+  registry->Register({"starts_with", {VARCHAR, VARCHAR}, TypeId::BOOLEAN, StartsWith});
+  registry->Register({"position", {VARCHAR, VARCHAR}, INTEGER, Position});
+}
+
+}  // namespace bustub
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/compressed_page_cache.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/page_checksum_table.h"
+#include "buffer/swip.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -14,6 +22,45 @@
 
 namespace bustub {
 
+/**
+ * FrameWaitStats summarizes how often and how long callers blocked waiting for a frame on a full buffer pool.
+ */
+struct FrameWaitStats {
+  /** Number of NewPage() / FetchPage() calls that had to wait for a frame. */
+  size_t waits_{0};
+  /** Number of waits that ran into the timeout without getting a frame. */
+  size_t timeouts_{0};
+  /** Total time spent waiting, summed over all waiters. */
+  std::chrono::nanoseconds wait_time_{0};
+};
+
+/** TryFetchStatus tells why a TryFetchPageRead() / TryFetchPageWrite() returned an empty guard. */
+enum class TryFetchStatus {
+  /** The guard holds the latched page. */
+  Ok,
+  /** The page latch is held by someone else. This is a conflict that can be retried. */
+  LatchBusy,
+  /** The page is not resident and every frame is pinned, so there is no frame to read it into. */
+  NoFrame,
+  /** The page was read from disk but failed checksum verification. */
+  ReadFailed,
+};
+
+/**
+ * ChecksumPolicy decides whether page checksums are maintained, and what happens when a page read from disk does not
+ * match its checksum.
+ */
+enum class ChecksumPolicy {
+  /** Checksums are neither recorded nor verified. */
+  Disabled,
+  /** Log a warning and hand out the page anyway. */
+  Warn,
+  /** Fail the fetch, i.e. FetchPage() returns nullptr. */
+  Reject,
+  /** Fail the fetch by throwing an Exception. */
+  Throw,
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -24,10 +71,14 @@ class BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
-   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). While logging is enabled, a dirty
+   * page is only written back once the log is durable up to the page LSN.
+   * @param page_size the size of the pages in this buffer pool. Must be a power of two multiple or divisor of
+   * BUSTUB_PAGE_SIZE, since pages are mapped onto the disk manager's BUSTUB_PAGE_SIZE blocks. Buffer pools with
+   * different page sizes should use separate disk managers.
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t page_size = BUSTUB_PAGE_SIZE);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -37,9 +88,69 @@ class BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t { return pool_size_; }
 
+  /** @brief Return the size of the pages in the buffer pool. */
+  auto GetPageSize() -> size_t { return page_size_; }
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return true if a frame belongs to this buffer pool. */
+  auto OwnsFrame(const Page *page) const -> bool { return page >= pages_ && page < pages_ + pool_size_; }
+
+  /**
+   * @brief Set how long NewPage() and FetchPage() may block waiting for a frame when every frame is pinned.
+   *
+   * Blocked callers are queued in FIFO order and the oldest one is woken up whenever UnpinPage() makes a frame
+   * evictable or DeletePage() returns a frame to the free list. A zero timeout (the default) disables waiting,
+   * so a full buffer pool returns nullptr immediately.
+   *
+   * @param timeout the maximum time a single call waits for a frame
+   */
+  void SetFrameWaitTimeout(std::chrono::milliseconds timeout);
+
+  /** @brief Return the statistics of callers waiting for a frame. */
+  auto GetFrameWaitStats() -> FrameWaitStats;
+
+  /**
+   * @brief Set the page checksum policy.
+   *
+   * Unless the policy is Disabled, a CRC32C of each page image is recorded in a PageChecksumTable before the image is
+   * written to disk, and verified when the page is read back. The checksums live outside of the pages, so every page
+   * layout keeps all of its page data. Pages without a recorded checksum always pass verification.
+   *
+   * @param policy the checksum policy
+   * @param checksum_disk_manager the disk manager for the checksum table, separate from the one holding the pages, or
+   * nullptr to keep the checksums in memory, which only verifies pages written since
+   */
+  void SetChecksumPolicy(ChecksumPolicy policy, DiskManager *checksum_disk_manager = nullptr);
+
+  /** @brief Return the number of pages read from disk that failed checksum verification. */
+  auto GetChecksumFailures() -> size_t;
+
+  /**
+   * @brief Enable a compressed second cache tier for evicted pages.
+   *
+   * Pages evicted from the buffer pool are kept compressed in memory (after being written back if dirty), and
+   * FetchPage() looks there before reading from disk. Should be called before the buffer pool is used.
+   *
+   * @param capacity the memory budget of the tier in bytes, 0 disables it
+   */
+  void SetCompressedCacheCapacity(size_t capacity);
+
+  /** @brief Return the compressed cache tier, or nullptr if it is disabled. */
+  auto GetCompressedCache() -> CompressedPageCache * { return compressed_cache_.get(); }
+
+  /**
+   * @brief Make this buffer pool one of several partitions sharing a disk manager.
+   *
+   * Page ids are then allocated as partition_index, partition_index + num_partitions, ..., so that the partition
+   * owning a page can be told from its id. Must be called before any page is created.
+   *
+   * @param num_partitions the number of partitions
+   * @param partition_index the index of this partition
+   */
+  void SetPageIdPartition(size_t num_partitions, size_t partition_index);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -54,6 +165,9 @@ class BufferPoolManager {
    * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
+   * If a frame wait timeout is set (see SetFrameWaitTimeout()), a full buffer pool blocks the caller until a frame
+   * becomes evictable or the timeout expires, instead of returning nullptr right away.
+   *
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
@@ -85,6 +199,11 @@ class BufferPoolManager {
    * to disk and update the metadata of the new page
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
+   * Waiting for a frame on a full buffer pool behaves like in NewPage().
+   *
+   * Every thread keeps a small cache of the frames it fetched last. A page found there is pinned without the latch
+   * or the page table, after checking the frame's generation to make sure it still holds the page. Such hits are
+   * recorded in the replacer in batches, the next time the thread takes the latch.
    *
    * @param page_id id of page to be fetched
    * @param access_type type of access to the page, only needed for leaderboard tests.
@@ -92,6 +211,15 @@ class BufferPoolManager {
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
+  /**
+   * @brief Like FetchPage, but never waits for a frame, regardless of the frame wait timeout.
+   *
+   * @param page_id id of page to be fetched
+   * @param[out] status if not nullptr, why nullptr was returned, or TryFetchStatus::Ok
+   * @return nullptr if page_id cannot be fetched right away, otherwise pointer to the requested page
+   */
+  auto TryFetchPage(page_id_t page_id, TryFetchStatus *status = nullptr) -> Page *;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -101,6 +229,7 @@ class BufferPoolManager {
    * that, depending on the function called, a guard is returned.
    * If FetchPageRead or FetchPageWrite is called, it is expected that
    * the returned page already has a read or write latch held, respectively.
+   * If the page cannot be fetched, an empty guard (IsValid() == false) is returned.
    *
    * @param page_id, the id of the page to fetch
    * @return PageGuard holding the fetched page
@@ -109,6 +238,76 @@ class BufferPoolManager {
   auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
   auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
 
+  /**
+   * @brief Non-blocking variants of FetchPageRead / FetchPageWrite
+   *
+   * If the page latch is held by someone else, the page is unpinned again and an
+   * empty guard is returned instead of waiting for the latch. This allows callers
+   * that take latches out of order to back off instead of deadlocking. They never
+   * wait for a frame either, regardless of the frame wait timeout.
+   *
+   * @param page_id, the id of the page to fetch
+   * @param[out] status if not nullptr, why the guard is empty, to tell a busy latch worth retrying from a full pool
+   * @return PageGuard holding the fetched and latched page, or an empty guard
+   */
+  auto TryFetchPageRead(page_id_t page_id, TryFetchStatus *status = nullptr) -> ReadPageGuard;
+  auto TryFetchPageWrite(page_id_t page_id, TryFetchStatus *status = nullptr) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for optimistic (latch-free) reading.
+   *
+   * The page is pinned like in FetchPageBasic, but no latch is taken. Readers must validate the returned guard
+   * after reading, see OptimisticPageGuard.
+   *
+   * @param page_id, the id of the page to fetch
+   * @return OptimisticPageGuard holding the fetched page, or an empty guard if the page cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
+
+  /**
+   * @brief Fetch the page a swip refers to, swizzling the swip if the page had to be looked up.
+   *
+   * A swizzled swip leads straight to its frame, which is pinned without the page table or the buffer pool latch. The
+   * access is not recorded in the replacer. An unswizzled swip works like FetchPage(page_id_t).
+   *
+   * @param swip the reference to the page
+   * @param access_type type of access to the page
+   * @return nullptr if the page cannot be fetched or the swip is swizzled into another buffer pool, otherwise pointer
+   * to the pinned page
+   */
+  auto FetchPage(Swip *swip, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /**
+   * @brief Pin the page a swip leads to if the swip is swizzled into this buffer pool, without any lookup.
+   * @param swip the reference to the page
+   * @return nullptr if the swip is not swizzled into one of our frames, otherwise pointer to the pinned page
+   */
+  auto FetchSwizzledPage(Swip *swip) -> Page *;
+
+  /** @brief PageGuard wrappers for FetchPage(Swip *). */
+  auto FetchPageBasic(Swip *swip) -> BasicPageGuard;
+  auto FetchPageRead(Swip *swip) -> ReadPageGuard;
+  auto FetchPageWrite(Swip *swip) -> WritePageGuard;
+
+  /**
+   * @brief Unswizzle a swip so that it can be destroyed or pointed elsewhere. Does nothing if it is not swizzled into
+   * this buffer pool.
+   * @param swip the swip to release
+   */
+  void ReleaseSwip(Swip *swip);
+
+  /**
+   * @brief Take a read-only snapshot of a page, for readers that must not hold latches for long, e.g. scans.
+   *
+   * The page is pinned and read latched only while the snapshot is taken. The first snapshot of a page version copies
+   * the page, later snapshots of the same version share that copy. Writers never pay for snapshots: a write simply
+   * starts a new version, and the old copy lives on as long as snapshots refer to it.
+   *
+   * @param page_id, the id of the page to snapshot
+   * @return the snapshot, or an empty snapshot (IsValid() == false) if the page cannot be fetched
+   */
+  auto FetchPageSnapshot(page_id_t page_id) -> PageSnapshot;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -125,6 +324,26 @@ class BufferPoolManager {
    */
   auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
+  /**
+   * @brief Unpin a page the caller holds pinned, as UnpinPage(page->GetPageId(), is_dirty). Used by the page guards.
+   *
+   * A clean unpin takes neither the latch nor the page table, unless it is the last pin and the replacer holds the
+   * frame unevictable.
+   *
+   * @param page the pinned page
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page was not pinned
+   */
+  auto UnpinFrame(Page *page, bool is_dirty) -> bool;
+
+  /**
+   * @brief Mark a page the caller holds pinned as dirty before it is unpinned, and enter it into the dirty page table.
+   * Used by the page guards on the first write to a page, so a page that is changed and logged while pinned is not
+   * missing from a checkpoint. Takes the latch only if the page is clean.
+   * @param page the pinned page
+   */
+  void MarkFrameDirty(Page *page);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -133,6 +352,9 @@ class BufferPoolManager {
    * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
    * Unset the dirty flag of the page after flushing.
    *
+   * The page is read latched while it is written, so the image on disk is consistent. The caller must not hold the
+   * page latch itself.
+   *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
@@ -142,9 +364,36 @@ class BufferPoolManager {
    * TODO(P1): Add implementation
    *
    * @brief Flush all the pages in the buffer pool to disk.
+   *
+   * While logging is enabled, the log is flushed once up to the highest page LSN before any page is written. The pages
+   * are read latched while they are written, and written as one batch as far as possible (see WriteFrames()); pages
+   * that are busy or need more of the log flushed are written one by one afterwards, as in FlushPage().
    */
   void FlushAllPages();
 
+  /**
+   * @brief Return a snapshot of the dirty page table, which maps every dirty page to its recLSN.
+   *
+   * The recLSN of a page is a lower bound for the LSN of the first change since it was last written to disk, so redo
+   * can start at the smallest recLSN. It is the log tail when the page was pinned for the change, or INVALID_LSN if
+   * the buffer pool has no log manager.
+   *
+   * Pages written through a page guard are in the table from their first GetDataMut() on. Pages changed through a raw
+   * Page pointer only enter it when they are unpinned as dirty.
+   */
+  auto GetDirtyPageTable() -> std::unordered_map<page_id_t, lsn_t>;
+
+  /**
+   * @brief Write back the dirty pages with the oldest recLSNs, to advance the redo start point.
+   *
+   * Pages that are currently latched for writing are skipped. The log is made durable once for all written pages, and
+   * they are written as one batch (see WriteFrames()).
+   *
+   * @param max_pages the maximum number of pages to write
+   * @return the number of pages written
+   */
+  auto FlushOldestDirtyPages(size_t max_pages) -> size_t;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -161,17 +410,29 @@ class BufferPoolManager {
   auto DeletePage(page_id_t page_id) -> bool;
 
  private:
+  /**
+   * How often eviction, deletion or write-back flushes the log for a page before giving up. Each flush makes the page
+   * writable, so only pages that keep getting new log records meanwhile run out of retries.
+   */
+  static constexpr size_t MAX_LOG_FLUSH_RETRIES = 8;
+
+  /** Unique id of this buffer pool, tells the entries of different buffer pools in a thread's frame cache apart. */
+  const uint64_t instance_id_;
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
+  /** Size of each page in the buffer pool. */
+  const size_t page_size_;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_ = 0;
+  /** The distance between page ids allocated by this buffer pool, see SetPageIdPartition(). */
+  page_id_t page_id_stride_{1};
 
-  /** Array of buffer pool pages. */
+  /** Array of buffer pool pages, one cache line of book-keeping per frame. */
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager, nullptr if logging is disabled. */
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
@@ -181,6 +442,41 @@ class BufferPoolManager {
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
   std::mutex latch_;
 
+  /** A caller blocked in AcquireFrame() until a frame becomes available. */
+  struct FrameWaiter {
+    std::condition_variable cv_;
+  };
+  /** Callers waiting for a frame, oldest first. Protected by latch_. */
+  std::list<FrameWaiter *> frame_waiters_;
+  /** How long a caller may wait for a frame, zero means no waiting. Protected by latch_. */
+  std::chrono::milliseconds frame_wait_timeout_{0};
+  /** Frame waiting statistics. Protected by latch_. */
+  FrameWaitStats frame_wait_stats_;
+  /** Page checksum policy. Protected by latch_. */
+  ChecksumPolicy checksum_policy_{ChecksumPolicy::Disabled};
+  /** The checksums of the pages written so far, nullptr while the policy is Disabled. Protected by latch_. */
+  std::unique_ptr<PageChecksumTable> checksum_table_;
+  /** Number of checksum verification failures. Protected by latch_. */
+  size_t checksum_failures_{0};
+  /** Dirty page table, mapping each dirty page to its recLSN. Protected by latch_. */
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
+  /** The dirty page table ordered by recLSN, oldest first. Protected by latch_. */
+  std::set<std::pair<lsn_t, page_id_t>> dirty_pages_by_rec_lsn_;
+  /** The latest snapshot copy of a resident page, shared by all snapshots of that frame version. */
+  struct SnapshotImage {
+    frame_id_t frame_id_;
+    uint64_t version_;
+    std::weak_ptr<const char[]> data_;
+  };
+  /** Snapshot copies by page. Entries are dropped when their page leaves the buffer pool. */
+  std::unordered_map<page_id_t, SnapshotImage> snapshot_images_;
+  /** Protects snapshot_images_. Never held while acquiring latch_. */
+  std::mutex snapshot_latch_;
+  /** The swip each frame is swizzled into, nullptr if none. Protected by latch_. */
+  std::vector<Swip *> frame_swips_;
+  /** Compressed cache tier for evicted pages, nullptr if disabled. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
    * @return the id of the allocated page
@@ -195,6 +491,133 @@ class BufferPoolManager {
     // This is a no-nop right now without a more complex data structure to track deallocated pages
   }
 
+  /**
+   * @brief Take a frame from the free list, or evict one (writing it back if dirty). Caller should acquire the latch
+   * before calling this function.
+   * @param[out] frame_id id of the acquired frame
+   * @param[out] flush_lsn INVALID_LSN, or the LSN the log has to be durable up to before the victim can be written
+   * @param[out] cache_ticket 0, or the compressed cache reservation for the victim, which the caller inserts into the
+   * compressed cache once it released the latch
+   * @return false if all frames are pinned, or the log has to be flushed first
+   */
+  auto TryAcquireFrame(frame_id_t *frame_id, lsn_t *flush_lsn, uint64_t *cache_ticket) -> bool;
+
+  /**
+   * @brief Acquire a frame for a new resident page, waiting up to frame_wait_timeout_ in FIFO order if all frames
+   * are pinned. The latch may be released while waiting, while the log is flushed for a dirty victim, or while the
+   * victim is compressed into the compressed cache tier.
+   * @param lock the caller's lock on latch_
+   * @param[out] frame_id id of the acquired frame
+   * @param wait false to fail right away rather than wait for a frame
+   * @return false if no frame became available in time
+   */
+  auto AcquireFrame(std::unique_lock<std::mutex> &lock, frame_id_t *frame_id, bool wait = true) -> bool;
+
+  /**
+   * @brief FetchPage(), optionally without waiting for a frame.
+   * @param page_id id of page to be fetched
+   * @param wait_for_frame false to fail right away on a full buffer pool
+   * @param[out] status if not nullptr, why nullptr was returned, or TryFetchStatus::Ok
+   */
+  auto FetchFrame(page_id_t page_id, bool wait_for_frame, TryFetchStatus *status) -> Page *;
+
+  /**
+   * @brief Write the page held by a frame to disk, recording its checksum and flushing the checksum table first, and
+   * mark it clean. Caller should acquire the latch, and make sure that nobody changes the page meanwhile: either the
+   * frame is claimed, or the caller holds the page read latch. The log must already be durable up to the page LSN.
+   * @param frame_id the frame to write out
+   */
+  void WriteFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Write out several frames like WriteFrame(), but record all of their checksums first, so that the checksum
+   * table is flushed once for the whole batch. Caller should acquire the latch and hold the read latch of every page.
+   * @param frame_ids the frames to write out
+   */
+  void WriteFrames(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * @brief Read latch a resident page and write it out with WriteFrame(). The page latch is only tried, since its
+   * holder may be waiting for latch_; while it is busy, latch_ is released and the lookup starts over. So it is while
+   * the log is flushed up to the page LSN.
+   * @param lock the caller's lock on latch_
+   * @param page_id the page to write out
+   * @return false if the page is not in the buffer pool, or its LSN kept moving past the durable log
+   * MAX_LOG_FLUSH_RETRIES times
+   */
+  auto WriteResidentPage(std::unique_lock<std::mutex> &lock, page_id_t page_id) -> bool;
+
+  /** @brief Mark a resident page dirty and enter it into the dirty page table. Caller should acquire the latch. */
+  void SetDirty(Page *page);
+
+  /** @brief Pin the resident page of a frame and record the access. Caller should acquire the latch. */
+  void PinFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Pin a frame without the latch. The caller has to check that the frame still holds the expected page.
+   * @return false if the frame is claimed and cannot be pinned
+   */
+  auto TryPinUnlatched(Page *page) -> bool;
+
+  /**
+   * @brief Claim a frame the replacer chose for eviction, so it can no longer be pinned. Caller should acquire the
+   * latch.
+   * @return false if the frame was pinned without the latch meanwhile; it is then handed back to the replacer as pinned
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /** @brief Pin a page through the calling thread's frame cache. @return nullptr on a cache miss */
+  auto FetchCachedFrame(page_id_t page_id) -> Page *;
+
+  /** @brief Enter a frame into the calling thread's frame cache. Caller should acquire the latch. */
+  void CacheFrame(page_id_t page_id, frame_id_t frame_id);
+
+  /** @brief Record the calling thread's frame cache hits in the replacer. Caller should acquire the latch. */
+  void RecordFrameCacheHits();
+
+  /** @brief Unswizzle the swip of a frame whose page leaves the buffer pool. Caller should acquire the latch. */
+  void UnswizzleFrame(frame_id_t frame_id);
+
+  /** @brief Forget the snapshot copy of a page that leaves the buffer pool. Caller should acquire the latch. */
+  void DropSnapshotImage(page_id_t page_id);
+
+  /**
+   * @brief Return true if the log is not yet durable up to lsn, so a page with that LSN cannot be written. LSNs at or
+   * past the log tail are treated as the last appended one, like LogManager::Flush() does.
+   */
+  auto LogFlushNeeded(lsn_t lsn) -> bool;
+
+  /**
+   * @brief Make the log durable up to lsn. The log is flushed without latch_, since that takes a disk write.
+   * @param lock the caller's lock on latch_, released while flushing
+   * @param lsn the LSN the log has to be durable up to
+   */
+  void FlushLog(std::unique_lock<std::mutex> &lock, lsn_t lsn);
+
+  /** @brief Return the next LSN of the log, or INVALID_LSN without a log manager. */
+  auto GetLogTail() -> lsn_t;
+
+  /**
+   * @brief Read a page from the compressed cache tier, or from disk into a frame and verify its checksum. Caller
+   * should acquire the latch.
+   * @param page_id the page to read
+   * @param frame_id the frame to read into
+   * @return false if the page failed verification and the checksum policy rejects it
+   */
+  auto ReadFrame(page_id_t page_id, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Write page data to disk, mapping it onto the disk manager's BUSTUB_PAGE_SIZE blocks. A large page spans
+   * several consecutive blocks, a small page shares a block with its neighbours. Caller should acquire the latch.
+   */
+  void WritePageToDisk(page_id_t page_id, const char *page_data);
+
+  /** @brief Read page data from disk, see WritePageToDisk(). Caller should acquire the latch. */
+  void ReadPageFromDisk(page_id_t page_id, char *page_data);
+
+  /** @brief Wake up the oldest waiter if a frame is available. Caller should acquire the latch. */
+  void NotifyFrameWaiter();
+
   // TODO(student): You may add additional private members and helper functions
 };
 }  // namespace bustub
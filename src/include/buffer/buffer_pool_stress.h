@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The operations a stress run mixes. */
+enum class StressOp { NewPage = 0, FetchRead, FetchWrite, FetchUnpin, DeletePage, FlushPage, FlushAllPages };
+
+/** Number of StressOp values. */
+static constexpr size_t NUM_STRESS_OPS = 7;
+
+/** Parameters of a BufferPoolStress run. */
+struct BufferPoolStressOptions {
+  /** Seeds the operation sequence of every thread. */
+  uint64_t seed_{0};
+  size_t num_threads_{4};
+  size_t ops_per_thread_{10000};
+  /** Stop creating pages once this many page ids were handed out. */
+  size_t max_pages_{1024};
+  /** Fraction of the fetches that go to the first 1/16 of the pages, to create hot pages. */
+  double hot_fraction_{0.5};
+  /** Relative frequencies of the operations, indexed by StressOp. */
+  std::array<size_t, NUM_STRESS_OPS> weights_{5, 50, 25, 10, 3, 5, 2};
+  /**
+   * Run the threads in lockstep: one operation at a time, in round-robin order of the threads. The interleaving is
+   * then fixed too, so a seed replays exactly. It gives up the races inside the buffer pool for that, so use it to
+   * replay and bisect logic errors, not to hunt for races. Operations that wait for a frame wait out the frame wait
+   * timeout, since nobody else can run meanwhile.
+   */
+  bool lockstep_{false};
+};
+
+/** The outcome of a BufferPoolStress run. */
+struct BufferPoolStressResult {
+  /** Operations run, indexed by StressOp. */
+  std::array<size_t, NUM_STRESS_OPS> ops_{};
+  /** Operations that found no free frame and were skipped. */
+  size_t pool_full_{0};
+  /** Number of disagreements with the model, 0 for a correct buffer pool. */
+  size_t failures_{0};
+  /** Description of the first disagreement. */
+  std::string first_failure_;
+  std::chrono::nanoseconds elapsed_{0};
+
+  /** @return the total number of operations run */
+  auto TotalOps() const -> size_t;
+
+  /** @return the operations run per second, over all threads */
+  auto OpsPerSecond() const -> double;
+
+  /** @return a one-line summary for logs */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * BufferPoolStress runs random mixes of NewPage, FetchPage*, UnpinPage, DeletePage and flushes on a buffer pool from
+ * several threads, and checks every result against a model of what the pages must contain.
+ *
+ * Each thread draws its operations from a generator seeded with the run seed and the thread index, so rerunning a seed
+ * repeats the operations of every thread. Only a lockstep run (see BufferPoolStressOptions::lockstep_) also repeats
+ * how the threads interleave; a free-running run is not deterministic. Every page carries its id and a
+ * version that each write increments. The model tracks which pages exist and their current version. A per-page model
+ * latch keeps deletions apart from everything else on the page, so the check stays exact: a fetch of a live page must
+ * succeed or report a full pool, and must see the current version. After the threads are done, the pages are flushed
+ * and every page is checked once more; with more pages than frames most of them are read back from disk.
+ *
+ * Pair it with a MemoryDiskManager to control the I/O latency. The buffer pool must be fresh and is left holding the
+ * created pages.
+ */
+class BufferPoolStress {
+ public:
+  /**
+   * @param bpm the buffer pool to stress, with no pages yet
+   * @param options the parameters of the run
+   */
+  BufferPoolStress(BufferPoolManager *bpm, BufferPoolStressOptions options);
+
+  /** @brief Run the threads and the final check. */
+  auto Run() -> BufferPoolStressResult;
+
+ private:
+  /** Where the stamp lives in a page, behind the page header. */
+  static constexpr size_t STAMP_OFFSET = 16;
+
+  /** The model of one page. */
+  struct ModelPage {
+    /** Held shared by every operation on the page, exclusive by deletion. */
+    std::shared_mutex latch_;
+    /** Set by NewPage, cleared by DeletePage. Protected by latch_. */
+    bool live_{false};
+    /** The number of writes to the page, updated under the page write latch. */
+    std::atomic<uint64_t> version_{0};
+  };
+
+  /** The result of one thread. */
+  struct ThreadResult {
+    std::array<size_t, NUM_STRESS_OPS> ops_{};
+    size_t pool_full_{0};
+    size_t failures_{0};
+    std::string first_failure_;
+  };
+
+  /** Holds a thread's turn for one operation in a lockstep run, and passes it on when destroyed. */
+  class LockstepTurn {
+   public:
+    LockstepTurn(BufferPoolStress *stress, size_t thread_index);
+    ~LockstepTurn();
+    DISALLOW_COPY_AND_MOVE(LockstepTurn);
+
+   private:
+    BufferPoolStress *stress_;
+  };
+
+  void RunThread(size_t thread_index, ThreadResult *result);
+
+  /** @brief Check the stamp of a page against the model. @return an empty string if it matches */
+  auto CheckStamp(page_id_t page_id, const char *data, uint64_t version) -> std::string;
+
+  void Stamp(page_id_t page_id, char *data, uint64_t version);
+
+  /** @brief Check every live page after the threads are done. */
+  void CheckAllPages(ThreadResult *result);
+
+  BufferPoolManager *bpm_;
+  BufferPoolStressOptions options_;
+  std::unique_ptr<ModelPage[]> model_;
+  /** The number of page ids handed out so far, all below max_pages_. */
+  std::atomic<size_t> num_pages_{0};
+
+  /** The number of operations run so far in a lockstep run, whose remainder by the thread count picks the next turn. */
+  size_t turn_{0};
+  std::mutex turn_latch_;
+  std::condition_variable turn_cv_;
+};
+
+}  // namespace bustub
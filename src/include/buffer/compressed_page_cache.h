@@ -0,0 +1,110 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCacheStats summarizes the effectiveness of a CompressedPageCache.
+ */
+struct CompressedPageCacheStats {
+  /** Lookups served from the cache. */
+  size_t hits_{0};
+  /** Lookups that had to go to disk. */
+  size_t misses_{0};
+  /** Pages added to the cache. */
+  size_t insertions_{0};
+  /** Pages dropped to stay within the memory budget. */
+  size_t evictions_{0};
+  /** Pages currently cached. */
+  size_t num_pages_{0};
+  /** Bytes currently used, including per-page bookkeeping. */
+  size_t memory_used_{0};
+};
+
+/**
+ * CompressedPageCache is a second cache tier behind the buffer pool. It keeps compressed copies of clean pages evicted
+ * from the buffer pool within a fixed memory budget, so re-referencing them costs a decompression instead of a disk
+ * read. It is exclusive: a page leaves the cache when it is looked up, since it then lives in a frame again.
+ *
+ * When the memory budget is exhausted the least recently inserted pages are dropped first.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * @brief Creates a new compressed page cache.
+   * @param capacity the memory budget in bytes
+   * @param page_size the size of the cached pages
+   */
+  explicit CompressedPageCache(size_t capacity, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  ~CompressedPageCache() = default;
+
+  /**
+   * @brief Announce that a page is about to be inserted. The buffer pool reserves under its latch when it evicts the
+   * page and inserts later without it, so the page may be read back or deleted in between; Lookup() and Erase()
+   * cancel the reservation, which keeps a late insertion from caching an outdated copy.
+   * @param page_id id of the page
+   * @return the ticket to pass to Insert()
+   */
+  auto Reserve(page_id_t page_id) -> uint64_t;
+
+  /**
+   * @brief Add a clean page to the cache, replacing an older copy of the same page. The page is compressed without
+   * holding the cache latch.
+   * @param page_id id of the page
+   * @param page_data the page contents, which must match the page on disk
+   * @param ticket the ticket from Reserve(). The page is not inserted if the reservation was cancelled or renewed.
+   */
+  void Insert(page_id_t page_id, const char *page_data, uint64_t ticket);
+
+  /**
+   * @brief Look up a page and, on a hit, decompress it and remove it from the cache.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer for the page contents
+   * @return true on a hit, false if the page has to be read from disk
+   */
+  auto Lookup(page_id_t page_id, char *page_data) -> bool;
+
+  /** @brief Drop a page from the cache, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** @return the cache statistics */
+  auto GetStats() -> CompressedPageCacheStats;
+
+ private:
+  /** Approximate bookkeeping memory per cached page (map node, LRU node, allocation header). */
+  static constexpr size_t ENTRY_OVERHEAD = 96;
+
+  struct Entry {
+    std::unique_ptr<char[]> data_;
+    /** Stored size, page_size_ if the page is stored uncompressed. */
+    size_t size_;
+    std::list<page_id_t>::iterator lru_pos_;
+  };
+
+  /** @brief Remove an entry. Caller should acquire the latch. */
+  void RemoveEntry(std::unordered_map<page_id_t, Entry>::iterator it);
+
+  const size_t capacity_;
+  const size_t page_size_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Cached pages, least recently inserted first. */
+  std::list<page_id_t> lru_list_;
+  CompressedPageCacheStats stats_;
+  /** The ticket of every reserved page that was not inserted yet. */
+  std::unordered_map<page_id_t, uint64_t> reservations_;
+  uint64_t next_ticket_{1};
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * MmapPageProvider serves pages straight out of a memory mapped database file, as an alternative to the
+ * BufferPoolManager for read-mostly datasets that fit in memory.
+ *
+ * Every page of the file is always addressable, so fetching a page is an array lookup: there is no page table, no
+ * pinning, no replacer and no copy from disk. The OS page cache does the caching, reading pages in on first touch and
+ * writing dirty pages back whenever it likes. The page guards work as with the buffer pool, except that they hold no
+ * pin, only the latch.
+ *
+ * Since the OS may write back a page at any time, the write-ahead rule cannot be enforced: do not use this provider
+ * for data that has to be recovered from the log. Checksums and compression are not supported either.
+ *
+ * The file is laid out like the DiskManager's, page i at offset i * page_size, so a database file written through a
+ * BufferPoolManager with the same page size can be opened here and vice versa.
+ */
+class MmapPageProvider {
+ public:
+  /**
+   * @brief Maps a database file, creating it if it does not exist.
+   * @param db_file the database file
+   * @param max_pages the maximum number of pages the file can grow to. Only address space is reserved for them.
+   * @param page_size the size of the pages, a multiple of CACHE_LINE_SIZE
+   * @param prefetch_pages how many pages to read ahead of sequential scans, 0 to leave read-ahead to the OS
+   */
+  MmapPageProvider(const std::string &db_file, size_t max_pages, size_t page_size = BUSTUB_PAGE_SIZE,
+                   size_t prefetch_pages = DEFAULT_PREFETCH_PAGES);
+
+  /**
+   * @brief Writes back all pages, unmaps the file and trims it to the pages handed out.
+   */
+  ~MmapPageProvider();
+
+  DISALLOW_COPY_AND_MOVE(MmapPageProvider);
+
+  /** @brief Return the size of the pages. */
+  auto GetPageSize() -> size_t { return page_size_; }
+
+  /** @brief Return the number of pages in the file. */
+  auto GetNumPages() -> size_t { return static_cast<size_t>(next_page_id_.load()); }
+
+  /**
+   * @brief Append a zeroed page to the file.
+   * @param[out] page_id id of created page
+   * @return nullptr if the file already has max_pages pages, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+  /** @brief PageGuard wrapper for NewPage. */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+
+  /**
+   * @brief Return a page of the file. A scan access reads ahead the following pages.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return nullptr if the page does not exist, otherwise pointer to the page
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /** @brief PageGuard wrappers for FetchPage, see BufferPoolManager. */
+  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
+
+  /**
+   * @brief Counterpart of BufferPoolManager::UnpinPage(). Pages are never pinned, and dirty pages are tracked by the
+   * OS, so this only checks that the page exists.
+   * @return false if the page does not exist
+   */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+
+  /**
+   * @brief Write a page back to the file and wait for it.
+   * @return false if the page does not exist
+   */
+  auto FlushPage(page_id_t page_id) -> bool;
+
+  /** @brief Write back all dirty pages and wait for them. */
+  void FlushAllPages();
+
+  /**
+   * @brief Zero a page and tell the OS that its memory can be dropped. Page ids are not reused, so the page stays
+   * addressable. The page must not be latched by anyone.
+   * @return false if the page does not exist
+   */
+  auto DeletePage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Ask the OS to read in a range of pages in the background, e.g. the leaves an index scan is going to visit.
+   * @param page_id the first page
+   * @param num_pages the number of pages, clipped to the end of the file
+   */
+  void Prefetch(page_id_t page_id, size_t num_pages);
+
+ private:
+  /** Default number of pages read ahead of scans. */
+  static constexpr size_t DEFAULT_PREFETCH_PAGES = 32;
+
+  /** @return the descriptor of an existing page, creating it on first use */
+  auto GetPage(page_id_t page_id) -> Page *;
+
+  /** @brief Grow the file so that it holds at least `num_pages` pages. */
+  void EnsureFileSize(size_t num_pages);
+
+  /** @brief madvise() a range of pages, widened to OS page boundaries. */
+  void Advise(page_id_t page_id, size_t num_pages, int advice);
+
+  std::string db_file_;
+  int fd_{-1};
+  /** The mapping, max_pages_ pages long, of which the first file_pages_ are backed by the file. */
+  char *data_{nullptr};
+  const size_t max_pages_;
+  const size_t page_size_;
+  const size_t prefetch_pages_;
+  /** The OS page size, the granularity of madvise() and msync(). */
+  size_t os_page_size_;
+
+  /** The next page id, i.e. the number of pages handed out. */
+  std::atomic<page_id_t> next_page_id_{0};
+  /** The number of pages the file is long, at least next_page_id_. Grown under file_latch_. */
+  std::atomic<size_t> file_pages_{0};
+  std::mutex file_latch_;
+
+  /** The descriptor of every page, created on first fetch. Only the latch and the version of a descriptor are used. */
+  std::vector<std::atomic<Page *>> pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/swip.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * NumaBufferPoolManager splits the buffer pool into one BufferPoolManager partition per NUMA node.
+ *
+ * Each partition is built by a thread bound to its node, so its frames and metadata are allocated in node-local memory
+ * (first-touch). New pages are created in the partition of the calling thread's node, falling back to the other
+ * partitions when the local one is full. A page is homed in the partition that created it, which is encoded in its id
+ * (see BufferPoolManager::SetPageIdPartition()), so fetches go straight to that partition. Threads that bind
+ * themselves to a node with NumaUtil::BindCurrentThread() are thereby served by node-local frames for the pages they
+ * create.
+ *
+ * When the home partition of a page has no frame for it, a fetch moves the page to another partition that has one,
+ * which becomes its home from then on; only when no partition has a frame does the fetch wait for one in the home. A
+ * page is only ever resident in its home partition: moves are recorded in a striped routing table, every operation on
+ * a page looks its home up with the page's stripe shared, and a move holds the stripe exclusively and only happens
+ * while the page is not resident anywhere.
+ */
+class NumaBufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new NumaBufferPoolManager with one partition per NUMA node.
+   * @param pool_size_per_node the number of frames in each partition
+   * @param disk_manager the disk manager shared by all partitions
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param page_size the size of the pages, must be BUSTUB_PAGE_SIZE: the partitions share the disk manager and
+   * could not coordinate writes of smaller pages to the same disk block
+   */
+  NumaBufferPoolManager(size_t pool_size_per_node, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                        LogManager *log_manager = nullptr, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  /** @brief Return the number of partitions, i.e. NUMA nodes. */
+  auto GetNumPartitions() -> size_t { return partitions_.size(); }
+
+  /** @brief Return the partition of a NUMA node. */
+  auto GetPartition(size_t node) -> BufferPoolManager * { return partitions_[node].get(); }
+
+  /** @brief Return the number of pages that were created in a remote partition because the local one was full. */
+  auto GetRemoteAllocations() -> size_t { return remote_allocations_.load(); }
+
+  /** @brief Return the number of pages that were moved to another partition because their home was full. */
+  auto GetRemoteFetches() -> size_t { return remote_fetches_.load(); }
+
+  /**
+   * @brief Create a new page, preferably in the partition of the calling thread's node.
+   * @param[out] page_id id of created page
+   * @return nullptr if all partitions are full, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+  /** @brief PageGuard wrapper for NewPage. */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+
+  /**
+   * @brief Fetch a page from its home partition, see BufferPoolManager::FetchPage(). If the home partition has no frame
+   * for the page, the page moves to another partition that has one.
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /** @brief PageGuard wrappers for FetchPage, see BufferPoolManager. */
+  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+
+  /**
+   * @brief Non-blocking fetches from the home partition, see BufferPoolManager::TryFetchPageRead(). They never move
+   * the page to another partition, since a move waits for the page's stripe of the routing table.
+   */
+  auto TryFetchPageRead(page_id_t page_id, TryFetchStatus *status = nullptr) -> ReadPageGuard;
+  auto TryFetchPageWrite(page_id_t page_id, TryFetchStatus *status = nullptr) -> WritePageGuard;
+
+  /** @brief Fetch a page for optimistic reading, see BufferPoolManager::FetchPageOptimistic(). */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
+
+  /** @brief Take a read-only snapshot of a page, see BufferPoolManager::FetchPageSnapshot(). */
+  auto FetchPageSnapshot(page_id_t page_id) -> PageSnapshot;
+
+  /**
+   * @brief Fetch the page a swip refers to, see BufferPoolManager::FetchPage(Swip *). A swizzled swip leads straight
+   * to a frame of whichever partition holds the page.
+   */
+  auto FetchPage(Swip *swip, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /** @brief PageGuard wrappers for FetchPage(Swip *). */
+  auto FetchPageBasic(Swip *swip) -> BasicPageGuard;
+  auto FetchPageRead(Swip *swip) -> ReadPageGuard;
+  auto FetchPageWrite(Swip *swip) -> WritePageGuard;
+
+  /** @brief Unswizzle a swip, see BufferPoolManager::ReleaseSwip(). */
+  void ReleaseSwip(Swip *swip);
+
+  /** @brief Unpin a page in its home partition, see BufferPoolManager::UnpinPage(). */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+
+  /** @brief Flush a page in its home partition, see BufferPoolManager::FlushPage(). */
+  auto FlushPage(page_id_t page_id) -> bool;
+
+  /** @brief Flush all the pages of all partitions. */
+  void FlushAllPages();
+
+  /** @brief Delete a page from its home partition, see BufferPoolManager::DeletePage(). */
+  auto DeletePage(page_id_t page_id) -> bool;
+
+ private:
+  /** Number of stripes of the routing table. */
+  static constexpr size_t NUM_ROUTE_STRIPES = 64;
+
+  /** A stripe of the routing table. Stripes are cache line aligned so that lookups on different stripes don't share. */
+  struct alignas(64) RouteStripe {
+    std::shared_mutex latch_;
+    /** Pages of this stripe that were moved away from the partition their id encodes, and their current home. */
+    std::unordered_map<page_id_t, size_t> homes_;
+  };
+
+  auto StripeOf(page_id_t page_id) -> RouteStripe & {
+    return route_stripes_[static_cast<size_t>(page_id) % NUM_ROUTE_STRIPES];
+  }
+
+  /** @return the home partition of a page. Caller should hold the page's stripe latch. */
+  auto HomeOf(RouteStripe &stripe, page_id_t page_id) -> size_t {
+    auto it = stripe.homes_.find(page_id);
+    return it == stripe.homes_.end() ? static_cast<size_t>(page_id) % partitions_.size() : it->second;
+  }
+
+  /** @return the home partition of a page */
+  auto PartitionOf(page_id_t page_id) -> BufferPoolManager * {
+    RouteStripe &stripe = StripeOf(page_id);
+    std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+    return partitions_[HomeOf(stripe, page_id)].get();
+  }
+
+  /** @return the partition a frame belongs to */
+  auto PartitionOfFrame(const Page *page) -> BufferPoolManager *;
+
+  /**
+   * Fetch and pin a page, moving it to another partition if its home has no frame for it. Waits for a frame in the
+   * home only after no partition had one, and never with the stripe held exclusively.
+   * @param page_id the page
+   * @param access_type type of access to the page
+   * @param[out] partition the partition the page is pinned in
+   * @return nullptr if the page cannot be fetched, otherwise pointer to the pinned page
+   */
+  auto FetchRouted(page_id_t page_id, AccessType access_type, BufferPoolManager **partition) -> Page *;
+
+  /**
+   * Bring a page that is not resident anywhere into the first partition that has a frame for it right now, and make
+   * that partition its home. Never waits for a frame.
+   * @param stripe the stripe of the page
+   * @param page_id the page
+   * @param[out] partition the partition the page is pinned in
+   * @return nullptr if no partition has a frame or the page cannot be read, otherwise pointer to the pinned page
+   */
+  auto MovePage(RouteStripe &stripe, page_id_t page_id, BufferPoolManager **partition) -> Page *;
+
+  /** One buffer pool per NUMA node, indexed by node. */
+  std::vector<std::unique_ptr<BufferPoolManager>> partitions_;
+  std::array<RouteStripe, NUM_ROUTE_STRIPES> route_stripes_;
+  std::atomic<size_t> remote_allocations_{0};
+  std::atomic<size_t> remote_fetches_{0};
+};
+
+}  // namespace bustub
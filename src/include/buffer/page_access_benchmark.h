@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/** The page access patterns PageAccessBenchmark can run. */
+enum class PageAccessWorkload {
+  /** 95% of the accesses take a read guard, 5% a write guard. */
+  ReadHeavy,
+  /** Half of the accesses take a read guard, half a write guard. */
+  Mixed,
+  /** Every access pins and unpins the page through a basic guard, without latching it: the hit path alone. */
+  PinOnly,
+};
+
+/** Parameters of a PageAccessBenchmark run. */
+struct PageAccessBenchmarkOptions {
+  PageAccessWorkload workload_{PageAccessWorkload::ReadHeavy};
+  size_t num_threads_{1};
+  /** The number of pages accessed, uniformly at random. Fewer pages mean more contention on each latch. */
+  size_t num_pages_{64};
+  /**
+   * Give every thread its own slice of the pages, so that threads never share a frame but do use neighbouring ones.
+   * This isolates false sharing between frame descriptors from contention on the same frame.
+   */
+  bool private_pages_{false};
+  std::chrono::milliseconds duration_{1000};
+  /** Seeds the page sequence of every thread. */
+  uint64_t seed_{0};
+};
+
+/** The outcome of a PageAccessBenchmark run. */
+struct PageAccessBenchmarkResult {
+  PageAccessBenchmarkOptions options_;
+  /** Accesses completed, over all threads. */
+  size_t ops_{0};
+  std::chrono::nanoseconds elapsed_{0};
+
+  /** @return the accesses per second, over all threads */
+  auto OpsPerSecond() const -> double;
+
+  /** @return a one-line summary for logs */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * PageAccessBenchmark measures the throughput of page guard acquisition from several threads, to see how the page
+ * latch and the pin path scale with the thread count.
+ *
+ * Every thread fetches random pages out of a fixed set for the configured time, reading a word of the page under a
+ * read guard or incrementing it under a write guard, or only pinning it. The pages are created up front; if the buffer
+ * pool has at least as many frames as there are pages, every access is a hit and the run measures only latching and
+ * pinning.
+ */
+class PageAccessBenchmark {
+ public:
+  /**
+   * @brief Run one workload on a buffer pool or another page provider with the same guard API.
+   * @param bpm the buffer pool (BufferPoolManager or MmapPageProvider), with no pages yet
+   * @param options the parameters of the run
+   */
+  template <class PageProvider>
+  static auto Run(PageProvider *bpm, const PageAccessBenchmarkOptions &options) -> PageAccessBenchmarkResult;
+
+  /**
+   * @brief Run one workload on a BufferPoolManager and on an MmapPageProvider, each over a fresh database file, to
+   * pick a page provider for a deployment.
+   *
+   * The dataset is `options.num_pages_` pages. It is in memory for the buffer pool if the pool has at least as many
+   * frames, and for the mmap provider if it fits in the OS page cache. For a larger-than-memory comparison, make the
+   * dataset larger than both the pool and the machine's RAM.
+   *
+   * @param db_file the database file to create, removed before each run
+   * @param pool_size the number of frames of the buffer pool
+   * @param options the parameters of both runs
+   * @return the result of the buffer pool, then the result of the mmap provider
+   */
+  static auto ComparePageProviders(const std::string &db_file, size_t pool_size,
+                                   const PageAccessBenchmarkOptions &options)
+      -> std::pair<PageAccessBenchmarkResult, PageAccessBenchmarkResult>;
+
+  /**
+   * @brief Run a workload at 1, 2, 4, ... up to `max_threads` threads, each on a fresh buffer pool.
+   * @param make_bpm called for every run, returns the buffer pool to run on
+   * @param options the parameters of the runs, but for the number of threads
+   * @param max_threads the largest thread count
+   * @return one result per thread count
+   */
+  template <class MakeBufferPool>
+  static auto RunScaling(MakeBufferPool make_bpm, PageAccessBenchmarkOptions options, size_t max_threads = 64)
+      -> std::vector<PageAccessBenchmarkResult> {
+    std::vector<PageAccessBenchmarkResult> results;
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      options.num_threads_ = num_threads;
+      auto bpm = make_bpm();
+      results.push_back(Run(&*bpm, options));
+    }
+    return results;
+  }
+};
+
+}  // namespace bustub
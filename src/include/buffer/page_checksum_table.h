@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * PageChecksumTable keeps the CRC32C of every page image the buffer pool writes to disk, outside of the pages
+ * themselves, so that page layouts keep all of the page data.
+ *
+ * The table is stored through its own disk manager, as BUSTUB_PAGE_SIZE blocks of fixed-size entries indexed by page
+ * id, and its blocks are read on first use. Record() only updates an entry in memory and marks its block dirty;
+ * Flush() writes the dirty blocks out. The buffer pool flushes the table before it writes the page images the entries
+ * describe, after recording a whole batch of them when it writes back several pages at once, so that each block is
+ * written once per batch rather than once per page. A crash can thereby only leave the table ahead of the data file,
+ * never behind it. An entry therefore remembers the previous checksum too: a page whose new image never made it to disk
+ * still verifies against the old one.
+ */
+class PageChecksumTable {
+ public:
+  /**
+   * @param disk_manager the disk manager holding the table, or nullptr to keep it in memory only, in which case only
+   * pages written since the table was created are verified
+   */
+  explicit PageChecksumTable(DiskManager *disk_manager) : disk_manager_(disk_manager) {}
+
+  DISALLOW_COPY_AND_MOVE(PageChecksumTable);
+
+  /**
+   * @brief Record the checksum of a page image that is about to be written to disk. The entry stays in memory until
+   * the next Flush(), which has to happen before the page image is written.
+   * @param page_id the page
+   * @param checksum the CRC32C of the page image
+   */
+  void Record(page_id_t page_id, uint32_t checksum);
+
+  /**
+   * @param page_id the page
+   * @param checksum the CRC32C of the page image read from disk
+   * @return true if the checksum is the last or second to last one recorded for the page, or the page has none
+   */
+  auto Verify(page_id_t page_id, uint32_t checksum) -> bool;
+
+  /** @brief Write out the blocks changed by Record() since the last flush, if the table has a disk manager. */
+  void Flush();
+
+ private:
+  /** The checksums of one page. */
+  struct Entry {
+    uint32_t current_;
+    uint32_t previous_;
+    /** Number of checksums recorded, saturating at 2. Zero means the page was never written. */
+    uint32_t num_recorded_;
+    uint32_t reserved_;
+  };
+  static constexpr size_t ENTRIES_PER_BLOCK = BUSTUB_PAGE_SIZE / sizeof(Entry);
+
+  /** @return the entries of a block, read from disk on first use. Caller should acquire the latch. */
+  auto GetBlock(page_id_t block_id) -> Entry *;
+
+  DiskManager *disk_manager_;
+  /** Protects blocks_ and dirty_blocks_, and serializes the writes of the table. */
+  std::mutex latch_;
+  /** The blocks read or written so far. */
+  std::unordered_map<page_id_t, std::unique_ptr<Entry[]>> blocks_;
+  /** The blocks changed since the last Flush(). */
+  std::unordered_set<page_id_t> dirty_blocks_;
+};
+
+}  // namespace bustub
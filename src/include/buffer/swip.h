@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * Swip is a reference to a page that skips the page table while the page is resident, after LeanStore's swizzled
+ * pointers.
+ *
+ * A swip is either unswizzled, holding the page id, or swizzled, holding a pointer to the frame the page is in.
+ * BufferPoolManager::FetchPage(Swip *) swizzles the swip the first time it brings the page in, so later hops go to the
+ * frame directly, and unswizzles it again when the page is evicted or deleted. A resident page is swizzled into at most
+ * one swip at a time. Other swips referring to it stay unswizzled and keep working through the page table.
+ *
+ * Swips are meant for hot in-memory references, e.g. to the root or the inner nodes of an index. A swizzled swip
+ * holds a memory address, so it must not be written into page data. It also must not be destroyed while swizzled; hand
+ * it back with BufferPoolManager::ReleaseSwip() first.
+ */
+class Swip {
+ public:
+  /** Creates a swip referring to no page. */
+  Swip() = default;
+
+  /** Creates an unswizzled swip referring to a page. */
+  explicit Swip(page_id_t page_id) : word_(Unswizzled(page_id)) {}
+
+  DISALLOW_COPY_AND_MOVE(Swip);
+
+  /** @return true if the swip currently points to a frame */
+  auto IsSwizzled() const -> bool { return IsSwizzled(word_.load(std::memory_order_acquire)); }
+
+ private:
+  friend class BufferPoolManager;
+  friend class NumaBufferPoolManager;
+
+  // Frames are cache line aligned, so the lowest bit of a frame pointer is always clear and can tag page ids.
+  static_assert(alignof(Page) > 1);
+
+  static auto Unswizzled(page_id_t page_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 1) | 1;
+  }
+  static auto Swizzled(Page *page) -> uint64_t { return reinterpret_cast<uintptr_t>(page); }
+  static auto IsSwizzled(uint64_t word) -> bool { return (word & 1) == 0; }
+  static auto PageIdOf(uint64_t word) -> page_id_t { return static_cast<page_id_t>(static_cast<uint32_t>(word >> 1)); }
+  static auto FrameOf(uint64_t word) -> Page * { return reinterpret_cast<Page *>(static_cast<uintptr_t>(word)); }
+
+  std::atomic<uint64_t> word_{Unswizzled(INVALID_PAGE_ID)};
+};
+
+}  // namespace bustub
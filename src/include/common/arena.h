@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Arena hands out memory for short-lived values, e.g. the results of evaluating an expression over a batch of rows,
+ * and frees all of it at once.
+ *
+ * Allocating bumps a pointer through a block; the next block is only taken once the current one is full. Nothing is
+ * freed individually. Reset() drops everything handed out, but keeps all blocks and reuses them in order, so an arena
+ * reset after every batch stops allocating once it has seen the largest batch.
+ */
+class Arena {
+ public:
+  /** @param block_size the size of the blocks, larger allocations get a block of their own */
+  explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+  ~Arena() = default;
+
+  DISALLOW_COPY_AND_MOVE(Arena);
+
+  /**
+   * @brief Allocate memory, valid until the next Reset() or the destruction of the arena.
+   * @param size the number of bytes, not aligned
+   */
+  auto Allocate(size_t size) -> char * {
+    if (size > static_cast<size_t>(end_ - next_)) {
+      NewBlock(size);
+    }
+    char *result = next_;
+    next_ += size;
+    return result;
+  }
+
+  /** @brief Free everything allocated so far. */
+  void Reset() {
+    current_ = 0;
+    next_ = blocks_.empty() ? nullptr : blocks_[0].data_.get();
+    end_ = blocks_.empty() ? nullptr : next_ + blocks_[0].size_;
+  }
+
+  /** @return the number of bytes held in blocks */
+  auto MemoryUsage() const -> size_t {
+    size_t usage = 0;
+    for (const auto &block : blocks_) {
+      usage += block.size_;
+    }
+    return usage;
+  }
+
+ private:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  struct Block {
+    std::unique_ptr<char[]> data_;
+    size_t size_;
+  };
+
+  void NewBlock(size_t min_size) {
+    // Move on to the first of the blocks kept by Reset() that is large enough, and only allocate if there is none.
+    size_t next = blocks_.empty() ? 0 : current_ + 1;
+    auto it = std::find_if(blocks_.begin() + next, blocks_.end(),
+                           [min_size](const Block &block) { return block.size_ >= min_size; });
+    if (it != blocks_.end()) {
+      std::swap(blocks_[next], *it);
+    } else {
+      size_t size = std::max(block_size_, min_size);
+      // Not value-initialized, the memory is always written before it is read.
+      blocks_.insert(blocks_.begin() + next, {std::unique_ptr<char[]>(new char[size]), size});
+    }
+    current_ = next;
+    next_ = blocks_[current_].data_.get();
+    end_ = next_ + blocks_[current_].size_;
+  }
+
+  const size_t block_size_;
+  /** The blocks, those before current_ are full and those after it were kept by Reset(). */
+  std::vector<Block> blocks_;
+  size_t current_{0};
+  /** The free part of the current block. */
+  char *next_{nullptr};
+  char *end_{nullptr};
+};
+
+}  // namespace bustub
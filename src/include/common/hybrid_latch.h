@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * HybridLatch is a reader-writer latch for short critical sections that fits in a single 32-bit word.
+ *
+ * A contended acquisition first spins with exponential backoff, then yields, and only parks the thread once that did
+ * not pay off, so short waits never turn into futex calls and context switches. Waiting writers block new readers,
+ * which keeps a steady stream of readers from starving writers.
+ *
+ * Parked threads sleep on a small global table of condition variables hashed by latch address (a "parking lot"), so
+ * the latch itself only carries its state word:
+ *
+ *  | writer (1) | parked (1) | waiting writers (14) | readers (16) |
+ */
+class HybridLatch {
+ public:
+  HybridLatch() = default;
+  ~HybridLatch() = default;
+
+  DISALLOW_COPY_AND_MOVE(HybridLatch);
+
+  /** Acquire the latch in exclusive mode. */
+  void WLock() {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | READER_MASK)) == 0 &&
+        state_.compare_exchange_strong(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return;
+    }
+    // Announce ourselves so that no new reader gets in while we wait.
+    state_.fetch_add(WAITING_WRITER, std::memory_order_relaxed);
+    Acquire([](uint32_t s) { return (s & (WRITER | READER_MASK)) == 0; },
+            [](uint32_t s) { return (s - WAITING_WRITER) | WRITER; });
+  }
+
+  /**
+   * Acquire the latch in exclusive mode if that is possible without waiting.
+   * @return true if the latch was acquired
+   */
+  auto TryWLock() -> bool {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    return (state & (WRITER | READER_MASK)) == 0 &&
+           state_.compare_exchange_strong(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  /** Release the latch held in exclusive mode. */
+  void WUnlock() {
+    uint32_t prev = state_.fetch_and(~WRITER, std::memory_order_release);
+    if ((prev & PARKED) != 0) {
+      UnparkAll();
+    }
+  }
+
+  /** Acquire the latch in shared mode. */
+  void RLock() {
+    Acquire([](uint32_t s) { return (s & (WRITER | WAITING_WRITER_MASK)) == 0 && (s & READER_MASK) != READER_MASK; },
+            [](uint32_t s) { return s + 1; });
+  }
+
+  /**
+   * Acquire the latch in shared mode if that is possible without waiting.
+   * @return true if the latch was acquired
+   */
+  auto TryRLock() -> bool {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while ((state & (WRITER | WAITING_WRITER_MASK)) == 0 && (state & READER_MASK) != READER_MASK) {
+      if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Try to turn a shared hold into an exclusive one without releasing the latch in between. This only succeeds if the
+   * caller is the sole reader.
+   * @return true if the latch is now held exclusively, false if it is still held in shared mode
+   */
+  auto TryUpgrade() -> bool {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while ((state & (WRITER | READER_MASK)) == 1) {
+      if (state_.compare_exchange_weak(state, (state - 1) | WRITER, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Turn an exclusive hold into a shared one without letting a writer in between. */
+  void Downgrade() {
+    uint32_t prev = state_.load(std::memory_order_relaxed);
+    while (!state_.compare_exchange_weak(prev, (prev & ~WRITER) + 1, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+    if ((prev & PARKED) != 0) {
+      UnparkAll();
+    }
+  }
+
+  /** Release the latch held in shared mode. */
+  void RUnlock() {
+    uint32_t prev = state_.fetch_sub(1, std::memory_order_release);
+    // Writers parked behind readers can go once the last reader leaves, readers only wait on readers on overflow.
+    uint32_t readers = prev & READER_MASK;
+    if ((readers == 1 || readers == READER_MASK) && (prev & PARKED) != 0) {
+      UnparkAll();
+    }
+  }
+
+ private:
+  static constexpr uint32_t WRITER = 1U << 31;
+  static constexpr uint32_t PARKED = 1U << 30;
+  static constexpr uint32_t WAITING_WRITER = 1U << 16;
+  static constexpr uint32_t WAITING_WRITER_MASK = 0x3FFFU << 16;
+  static constexpr uint32_t READER_MASK = 0xFFFFU;
+
+  /** Backoff rounds before yielding, each one pauses twice as long as the previous one. */
+  static constexpr uint32_t SPIN_ROUNDS = 10;
+  /** Yields before parking. */
+  static constexpr uint32_t YIELD_ROUNDS = 4;
+  static constexpr size_t PARKING_LOT_SIZE = 64;
+
+  struct alignas(64) ParkingBucket {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+  };
+
+  static auto GetParkingBucket(const void *latch) -> ParkingBucket & {
+    static std::array<ParkingBucket, PARKING_LOT_SIZE> parking_lot;
+    return parking_lot[std::hash<const void *>{}(latch) % PARKING_LOT_SIZE];
+  }
+
+  static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  /**
+   * Spin, yield, then park until `can_acquire` holds for the state word, and CAS the state to `acquired(state)`.
+   */
+  template <class CanAcquire, class Acquired>
+  void Acquire(CanAcquire can_acquire, Acquired acquired) {
+    uint32_t round = 0;
+    while (true) {
+      uint32_t state = state_.load(std::memory_order_relaxed);
+      if (can_acquire(state)) {
+        if (state_.compare_exchange_weak(state, acquired(state), std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+          return;
+        }
+        continue;
+      }
+      if (round < SPIN_ROUNDS) {
+        for (uint32_t i = 0; i < (1U << round); i++) {
+          CpuRelax();
+        }
+      } else if (round < SPIN_ROUNDS + YIELD_ROUNDS) {
+        std::this_thread::yield();
+      } else {
+        Park(can_acquire);
+      }
+      round++;
+    }
+  }
+
+  /**
+   * Sleep until some holder releases the latch. The parked bit is set under the bucket mutex and only if the latch is
+   * still unavailable, and releasers notify under the same mutex, so a wake-up cannot get lost.
+   */
+  template <class CanAcquire>
+  void Park(CanAcquire can_acquire) {
+    ParkingBucket &bucket = GetParkingBucket(this);
+    std::unique_lock<std::mutex> lock(bucket.mutex_);
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (!can_acquire(state)) {
+      if ((state & PARKED) != 0 ||
+          state_.compare_exchange_weak(state, state | PARKED, std::memory_order_relaxed, std::memory_order_relaxed)) {
+        bucket.cv_.wait(lock);
+        return;
+      }
+    }
+  }
+
+  void UnparkAll() {
+    state_.fetch_and(~PARKED, std::memory_order_relaxed);
+    ParkingBucket &bucket = GetParkingBucket(this);
+    std::scoped_lock<std::mutex> lock(bucket.mutex_);
+    bucket.cv_.notify_all();
+  }
+
+  std::atomic<uint32_t> state_{0};
+};
+
+}  // namespace bustub
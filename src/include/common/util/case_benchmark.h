@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace bustub {
+
+/** Parameters of a CaseBenchmark run. */
+struct CaseBenchmarkOptions {
+  /** The length of the strings converted, in bytes. */
+  size_t length_{32};
+  /** Put a two-byte UTF-8 character into every 64 bytes, so that every block takes the byte-by-byte fallback. */
+  bool non_ascii_{false};
+  /** How long each of the two conversions is timed. */
+  std::chrono::milliseconds duration_{200};
+};
+
+/** The outcome of a CaseBenchmark run. */
+struct CaseBenchmarkResult {
+  CaseBenchmarkOptions options_;
+  /** Average time of one CaseUtil conversion, in nanoseconds. */
+  double kernel_ns_{0};
+  /** Average time of one conversion with std::transform and ::toupper / ::tolower, in nanoseconds. */
+  double baseline_ns_{0};
+
+  /** @return how many times faster the CaseUtil kernels are than the baseline */
+  auto Speedup() const -> double;
+
+  /** @return a one-line summary for logs */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * CaseBenchmark times the upper() / lower() kernels of CaseUtil against the per-character std::transform they
+ * replaced, on mixed-case strings of a given length. Both sides alternate between converting to upper and to lower
+ * case, so neither converts an already converted string.
+ */
+class CaseBenchmark {
+ public:
+  /**
+   * @brief Time both conversions on one string length.
+   * @param options the parameters of the run
+   */
+  static auto Run(const CaseBenchmarkOptions &options) -> CaseBenchmarkResult;
+
+  /**
+   * @brief Time both conversions on short and long strings.
+   * @param lengths the string lengths to run
+   * @param options the parameters of the runs, but for the length
+   * @return one result per length
+   */
+  static auto RunLengths(const std::vector<size_t> &lengths = {8, 32, 256, 4096, 65536},
+                         CaseBenchmarkOptions options = {}) -> std::vector<CaseBenchmarkResult>;
+};
+
+}  // namespace bustub
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * CaseUtil converts strings to upper or lower case, for the upper() and lower() SQL functions.
+ *
+ * ASCII letters are converted with SSE2, AVX2 or AVX-512 kernels picked at startup by what the CPU supports, a block of
+ * 16 to 64 bytes at a time and without a branch per character. A block holding a non-ASCII byte is converted byte by
+ * byte with toupper() / tolower() instead, so the result is the same as converting the whole string with them.
+ */
+class CaseUtil {
+ public:
+  /**
+   * Convert a buffer to upper case.
+   *
+   * @param src the data to convert
+   * @param len the length of the data
+   * @param dst the output buffer, at least `len` bytes long. May be `src` to convert in place.
+   */
+  static void ToUpper(const char *src, size_t len, char *dst);
+
+  /** Convert a buffer to lower case, see ToUpper(). */
+  static void ToLower(const char *src, size_t len, char *dst);
+};
+
+}  // namespace bustub
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * ChecksumUtil provides fast checksums for detecting torn or corrupted pages.
+ */
+class ChecksumUtil {
+ public:
+  /**
+   * Compute the CRC32C (Castagnoli) of a buffer. Uses the SSE4.2 / ARMv8 CRC instructions when the CPU supports them
+   * and a table-driven implementation otherwise; both produce the same result.
+   *
+   * @param data the buffer to checksum
+   * @param len the length of the buffer in bytes
+   * @param crc the CRC of the preceding data, to checksum non-contiguous pieces as one stream
+   * @return the CRC32C of the data
+   */
+  static auto Crc32c(const char *data, size_t len, uint32_t crc = 0) -> uint32_t;
+};
+
+}  // namespace bustub
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * CompressionUtil provides a fast LZ77-family block codec for page-sized buffers.
+ *
+ * The format is the LZ4 block format: a sequence of tokens, each carrying a run of literals and a back-reference of at
+ * least four bytes into the previous 64 KB. It trades compression ratio for speed, so that compressing pages on the
+ * I/O path costs far less than the I/O it saves.
+ */
+class CompressionUtil {
+ public:
+  /** @return the worst-case compressed size of `len` input bytes */
+  static constexpr auto MaxCompressedSize(size_t len) -> size_t { return len + len / 255 + 16; }
+
+  /**
+   * Compress a buffer.
+   *
+   * @param src the data to compress
+   * @param len the length of the data
+   * @param dst the output buffer
+   * @param capacity the size of the output buffer
+   * @return the compressed size, or 0 if the compressed data does not fit in `capacity`
+   */
+  static auto Compress(const char *src, size_t len, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * Decompress a buffer produced by Compress().
+   *
+   * @param src the compressed data
+   * @param len the length of the compressed data
+   * @param dst the output buffer
+   * @param capacity the size of the output buffer
+   * @return the decompressed size, or 0 if the input is malformed or does not fit in `capacity`
+   */
+  static auto Decompress(const char *src, size_t len, char *dst, size_t capacity) -> size_t;
+};
+
+}  // namespace bustub
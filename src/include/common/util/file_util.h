@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/**
+ * FileUtil provides the POSIX file operations needed to make small side files durable, e.g. checkpoints and page
+ * mapping tables. All of them throw an Exception on I/O errors.
+ */
+class FileUtil {
+ public:
+  /**
+   * Write a whole buffer to a file descriptor, retrying short and interrupted writes.
+   * @param fd the file descriptor
+   * @param data the data to write
+   * @param size the length of the data
+   * @param file the file name, for error messages
+   */
+  static void WriteAll(int fd, const char *data, size_t size, const std::string &file);
+
+  /**
+   * Write a whole buffer at an offset of a file descriptor, retrying short and interrupted writes. Does not move the
+   * file position, so concurrent writes to disjoint ranges are safe.
+   * @param fd the file descriptor
+   * @param data the data to write
+   * @param size the length of the data
+   * @param offset the offset in the file
+   * @param file the file name, for error messages
+   */
+  static void WriteAllAt(int fd, const char *data, size_t size, uint64_t offset, const std::string &file);
+
+  /**
+   * fsync a file descriptor.
+   * @param fd the file descriptor
+   * @param file the file name, for error messages
+   */
+  static void Sync(int fd, const std::string &file);
+
+  /**
+   * fsync the directory holding a file, which makes creating or renaming the file durable.
+   * @param file the file whose directory to sync
+   */
+  static void SyncParentDirectory(const std::string &file);
+
+  /**
+   * Atomically and durably replace the contents of a file: the data is written to `<file>.tmp` and synced, renamed
+   * over the file, and the directory is synced. A crash leaves either the old or the new contents.
+   * @param file the file to replace
+   * @param data the new contents
+   */
+  static void ReplaceFile(const std::string &file, const std::string &data);
+};
+
+}  // namespace bustub
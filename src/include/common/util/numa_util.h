@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * NumaUtil exposes the NUMA topology of the machine and lets threads bind themselves to a node.
+ *
+ * The topology is read once from sysfs. Only online nodes with CPUs are reported, numbered densely from 0 in the
+ * order of their sysfs ids, so memory-only nodes and gaps in the numbering don't show up as empty nodes. On machines
+ * (or platforms) without NUMA information everything is reported as a single node 0, so callers don't need a separate
+ * code path.
+ */
+class NumaUtil {
+ public:
+  /** @return the number of NUMA nodes, at least 1 */
+  static auto NumNodes() -> size_t;
+
+  /** @return the NUMA node of the CPU the calling thread is running on */
+  static auto CurrentNode() -> size_t;
+
+  /** @return the CPUs that belong to a node */
+  static auto NodeCpus(size_t node) -> std::vector<int>;
+
+  /**
+   * Restrict the calling thread to the CPUs of a node, so that memory it touches first is allocated on that node.
+   * @param node the node to bind to
+   * @return false if the thread could not be bound
+   */
+  static auto BindCurrentThread(size_t node) -> bool;
+};
+
+}  // namespace bustub
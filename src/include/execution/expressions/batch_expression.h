@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/arena.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * StringBatch is a column of VARCHAR values, the input and output of batch string evaluation.
+ *
+ * The strings of all rows are packed back to back into one buffer, and row i spans [offsets_[i], offsets_[i + 1]) of
+ * it. A NULL row spans no bytes. Clearing a batch keeps its buffers, so a batch reused across calls stops allocating
+ * once it has grown to the largest batch.
+ */
+class StringBatch {
+ public:
+  StringBatch() = default;
+
+  /** @return the number of rows */
+  auto Size() const -> size_t { return is_null_.size(); }
+
+  /** @return true if row `i` is NULL */
+  auto IsNull(size_t i) const -> bool { return is_null_[i]; }
+
+  /** @return the string of row `i`, empty if the row is NULL */
+  auto Get(size_t i) const -> std::string_view { return {data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]}; }
+
+  /** @return the strings of all rows back to back */
+  auto Data() const -> const char * { return data_.data(); }
+
+  /** @return the total length of the strings */
+  auto DataSize() const -> size_t { return data_.size(); }
+
+  /** @brief Remove all rows, keeping the buffers. */
+  void Clear() {
+    data_.clear();
+    offsets_.resize(1);
+    is_null_.clear();
+  }
+
+  /** @brief Make room for `rows` more rows holding `bytes` more bytes. */
+  void Reserve(size_t rows, size_t bytes) {
+    data_.reserve(data_.size() + bytes);
+    offsets_.reserve(offsets_.size() + rows);
+    is_null_.reserve(is_null_.size() + rows);
+  }
+
+  /** @brief Append a row. */
+  void Append(std::string_view str) { memcpy(AppendUninitialized(str.size()), str.data(), str.size()); }
+
+  /** @brief Append a NULL row. */
+  void AppendNull() {
+    offsets_.push_back(data_.size());
+    is_null_.push_back(true);
+  }
+
+  /**
+   * @brief Append a row of `len` bytes for the caller to fill in.
+   * @return where to write the row, valid until the next append
+   */
+  auto AppendUninitialized(size_t len) -> char * {
+    size_t offset = data_.size();
+    data_.resize(offset + len);
+    offsets_.push_back(data_.size());
+    is_null_.push_back(false);
+    return data_.data() + offset;
+  }
+
+  /**
+   * @brief Replace the rows with rows of the same lengths and NULLs as `other`, for the caller to fill in.
+   * @return where to write the strings, back to back like other.Data()
+   */
+  auto ResizeLike(const StringBatch &other) -> char * {
+    data_.resize(other.data_.size());
+    offsets_ = other.offsets_;
+    is_null_ = other.is_null_;
+    return data_.data();
+  }
+
+ private:
+  std::vector<char> data_;
+  std::vector<size_t> offsets_{0};
+  std::vector<bool> is_null_;
+};
+
+/**
+ * BatchExpression is implemented by expressions that can be evaluated a batch of rows at a time, next to the per-row
+ * AbstractExpression::Evaluate(). Evaluating a batch pays the virtual call, the Value conversions and the allocations
+ * once per batch instead of once per row, and lets the expression run its kernel over the whole column.
+ *
+ * Executors check for the interface with dynamic_cast and fall back to Evaluate() for expressions without it.
+ */
+class BatchExpression {
+ public:
+  virtual ~BatchExpression() = default;
+
+  /**
+   * @brief Evaluate the expression over a column of strings.
+   * @param input the values of the argument, one per row
+   * @param[out] output cleared, then filled with the result of each row
+   */
+  virtual void EvaluateBatch(const StringBatch &input, StringBatch *output) const = 0;
+
+  /**
+   * @brief Evaluate the expression over a batch of tuples, with the string results written into an arena instead of
+   * being allocated per row.
+   * @param tuples the rows of the batch
+   * @param schema the schema of the rows
+   * @param arena holds the string results. They are owned by the arena, not by the returned values, and stay valid
+   * until it is reset, so reset it once the batch is done with.
+   * @param[out] output cleared, then filled with the result of each row
+   */
+  virtual void EvaluateBatch(const std::vector<Tuple> &tuples, const Schema &schema, Arena *arena,
+                             std::vector<Value> *output) const = 0;
+};
+
+}  // namespace bustub
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/batch_expression.h"
+#include "execution/function_registry.h"
+#include "fmt/format.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * ScalarFunctionExpression calls a function from the FunctionRegistry on the values of its children.
+ */
+class ScalarFunctionExpression : public AbstractExpression, public BatchExpression {
+ public:
+  /**
+   * @param function the overload to call, owned by the registry
+   * @param args the arguments, of the types the overload takes or of narrower integer types, which are cast to the
+   * types taken on every call (see FunctionRegistry::Resolve())
+   */
+  ScalarFunctionExpression(const ScalarFunction *function, std::vector<AbstractExpressionRef> args)
+      : AbstractExpression(std::move(args), function->return_type_), function_(function) {
+    for (size_t i = 0; i < GetChildren().size(); i++) {
+      promote_ = promote_ || GetChildAt(i)->GetReturnType() != function_->ArgType(i);
+    }
+  }
+
+  /** @return the function this expression calls */
+  auto GetFunction() const -> const ScalarFunction * { return function_; }
+
+  /** @brief Call the function on already evaluated arguments. */
+  auto Call(const std::vector<Value> &args) const -> Value {
+    if (HasNullArg(args)) {
+      return ValueFactory::GetNullValueByType(function_->return_type_);
+    }
+    return promote_ ? function_->eval_(Promote(args)) : function_->eval_(args);
+  }
+
+  /** @brief Call the function on already evaluated arguments, with a VARCHAR result written into the arena. */
+  auto Call(const std::vector<Value> &args, Arena *arena) const -> Value {
+    if (function_->arena_eval_ == nullptr) {
+      return Call(args);
+    }
+    if (HasNullArg(args)) {
+      return ValueFactory::GetNullValueByType(function_->return_type_);
+    }
+    return promote_ ? function_->arena_eval_(Promote(args), arena) : function_->arena_eval_(args, arena);
+  }
+
+  auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
+    std::vector<Value> args;
+    args.reserve(GetChildren().size());
+    for (const auto &child : GetChildren()) {
+      args.push_back(child->Evaluate(tuple, schema));
+    }
+    return Call(args);
+  }
+
+  auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
+                    const Schema &right_schema) const -> Value override {
+    std::vector<Value> args;
+    args.reserve(GetChildren().size());
+    for (const auto &child : GetChildren()) {
+      args.push_back(child->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema));
+    }
+    return Call(args);
+  }
+
+  /**
+   * Uses the vectorized evaluator of the function if it has one, and calls it row by row otherwise.
+   * @throws NotImplementedException if the function does not map one VARCHAR to a VARCHAR
+   */
+  void EvaluateBatch(const StringBatch &input, StringBatch *output) const override {
+    if (function_->batch_eval_ != nullptr) {
+      function_->batch_eval_(input, output);
+      return;
+    }
+    if (GetChildren().size() != 1 || function_->ArgType(0) != TypeId::VARCHAR ||
+        function_->return_type_ != TypeId::VARCHAR) {
+      throw NotImplementedException(fmt::format("{} cannot be evaluated on a string batch", function_->name_));
+    }
+    output->Clear();
+    std::vector<Value> args(1);
+    for (size_t i = 0; i < input.Size(); i++) {
+      if (input.IsNull(i)) {
+        args[0] = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+      } else {
+        args[0] = ValueFactory::GetVarcharValue(std::string(input.Get(i)));
+      }
+      Value res = Call(args);
+      if (res.IsNull()) {
+        output->AppendNull();
+      } else {
+        output->Append(res.GetAs<char *>());
+      }
+    }
+  }
+
+  /**
+   * Functions with an arena evaluator write their results into the arena. The results of other functions own their
+   * strings.
+   */
+  void EvaluateBatch(const std::vector<Tuple> &tuples, const Schema &schema, Arena *arena,
+                     std::vector<Value> *output) const override {
+    output->clear();
+    output->reserve(tuples.size());
+    std::vector<Value> args(GetChildren().size());
+    for (const auto &tuple : tuples) {
+      for (size_t i = 0; i < args.size(); i++) {
+        args[i] = GetChildAt(i)->Evaluate(&tuple, schema);
+      }
+      output->push_back(Call(args, arena));
+    }
+  }
+
+  /** @return the string representation of the expression node and its children */
+  auto ToString() const -> std::string override {
+    std::string args;
+    for (size_t i = 0; i < GetChildren().size(); i++) {
+      args += (i == 0 ? "" : ", ") + GetChildAt(i)->ToString();
+    }
+    return fmt::format("{}({})", function_->name_, args);
+  }
+
+  BUSTUB_EXPR_CLONE_WITH_CHILDREN(ScalarFunctionExpression);
+
+ private:
+  /** @return true if the function is strict and one of the arguments is NULL */
+  auto HasNullArg(const std::vector<Value> &args) const -> bool {
+    return function_->strict_ && std::any_of(args.begin(), args.end(), [](const Value &arg) { return arg.IsNull(); });
+  }
+
+  /** @return the arguments cast to the types the function takes */
+  auto Promote(const std::vector<Value> &args) const -> std::vector<Value> {
+    std::vector<Value> promoted;
+    promoted.reserve(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+      TypeId type = function_->ArgType(i);
+      promoted.push_back(args[i].GetTypeId() == type ? args[i] : args[i].CastAs(type));
+    }
+    return promoted;
+  }
+
+  const ScalarFunction *function_;
+  /** Set if some argument has a narrower type than the function takes and has to be cast on every call. */
+  bool promote_{false};
+};
+
+}  // namespace bustub
@@ -1,15 +1,17 @@
 #pragma once
 
-#include <algorithm>
-#include <cctype>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/arena.h"
 #include "common/exception.h"
 #include "common/macros.h"
+#include "common/util/case_util.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/batch_expression.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 #include "type/type.h"
@@ -23,7 +25,7 @@ enum class StringExpressionType { Lower, Upper };
 /**
  * StringExpression represents two expressions being computed.
  */
-class StringExpression : public AbstractExpression {
+class StringExpression : public AbstractExpression, public BatchExpression {
  public:
   StringExpression(AbstractExpressionRef arg, StringExpressionType expr_type)
       : AbstractExpression({std::move(arg)}, TypeId::VARCHAR), expr_type_{expr_type} {
@@ -33,30 +35,36 @@ class StringExpression : public AbstractExpression {
   }
 
   auto Compute(const std::string &val) const -> std::string {
-    // TODO(student): implement upper / lower.
     std::string res(val.size(), ' ');
-    switch (expr_type_) {
-      case StringExpressionType::Upper:
-        std::transform(val.begin(), val.end(), res.begin(), ::toupper);
-        break;
-      case StringExpressionType::Lower:
-        std::transform(val.begin(), val.end(), res.begin(), ::tolower);
-        break;
-    }
+    Convert(val.data(), val.size(), res.data());
     return res;
   }
 
   auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
-    Value val = GetChildAt(0)->Evaluate(tuple, schema);
-    auto str = val.GetAs<char *>();
-    return ValueFactory::GetVarcharValue(Compute(str));
+    return ComputeValue(GetChildAt(0)->Evaluate(tuple, schema));
   }
 
   auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                     const Schema &right_schema) const -> Value override {
-    Value val = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
-    auto str = val.GetAs<char *>();
-    return ValueFactory::GetVarcharValue(Compute(str));
+    return ComputeValue(GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema));
+  }
+
+  /**
+   * Case conversion maps every byte on its own, so a whole batch is converted by a single kernel call over the packed
+   * strings, with the row boundaries and NULLs carried over unchanged.
+   */
+  void EvaluateBatch(const StringBatch &input, StringBatch *output) const override {
+    char *dst = output->ResizeLike(input);
+    Convert(input.Data(), input.DataSize(), dst);
+  }
+
+  void EvaluateBatch(const std::vector<Tuple> &tuples, const Schema &schema, Arena *arena,
+                     std::vector<Value> *output) const override {
+    output->clear();
+    output->reserve(tuples.size());
+    for (const auto &tuple : tuples) {
+      output->push_back(ComputeValue(GetChildAt(0)->Evaluate(&tuple, schema), arena));
+    }
   }
 
   /** @return the string representation of the expression node and its children */
@@ -67,6 +75,37 @@ class StringExpression : public AbstractExpression {
   StringExpressionType expr_type_;
 
  private:
+  /** upper() and lower() of NULL is NULL. */
+  auto ComputeValue(const Value &val) const -> Value {
+    if (val.IsNull()) {
+      return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+    }
+    return ValueFactory::GetVarcharValue(Compute(val.GetAs<char *>()));
+  }
+
+  /** Like ComputeValue(const Value &), but the result is written into the arena and not owned by the value. */
+  auto ComputeValue(const Value &val, Arena *arena) const -> Value {
+    if (val.IsNull()) {
+      return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+    }
+    std::string_view str(val.GetAs<char *>());
+    // VARCHAR values carry their terminating null byte.
+    char *res = arena->Allocate(str.size() + 1);
+    Convert(str.data(), str.size(), res);
+    res[str.size()] = '\0';
+    return ValueFactory::GetVarcharValue(res, static_cast<uint32_t>(str.size() + 1), false);
+  }
+
+  void Convert(const char *src, size_t len, char *dst) const {
+    switch (expr_type_) {
+      case StringExpressionType::Upper:
+        CaseUtil::ToUpper(src, len, dst);
+        break;
+      case StringExpressionType::Lower:
+        CaseUtil::ToLower(src, len, dst);
+        break;
+    }
+  }
 };
 }  // namespace bustub
 
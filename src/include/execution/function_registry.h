@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/arena.h"
+#include "execution/expressions/batch_expression.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** Evaluates a function on one row. The arguments have the types the function was registered with. */
+using ScalarFunctionEval = auto (*)(const std::vector<Value> &args) -> Value;
+
+/** Evaluates a function of one VARCHAR argument returning VARCHAR on a whole column, see BatchExpression. */
+using BatchFunctionEval = void (*)(const StringBatch &input, StringBatch *output);
+
+/** Evaluates a function returning VARCHAR on one row, writing the result into an arena instead of allocating it. */
+using ArenaFunctionEval = auto (*)(const std::vector<Value> &args, Arena *arena) -> Value;
+
+/** A scalar function callable from SQL, one overload of a name. */
+struct ScalarFunction {
+  /** The name the function is called by, in lower case. */
+  std::string name_;
+  /**
+   * The types of the arguments. A call resolves to this overload if its argument types match exactly, or if integer
+   * arguments are narrower than the types taken, see FunctionRegistry::Resolve().
+   */
+  std::vector<TypeId> arg_types_;
+  TypeId return_type_;
+  ScalarFunctionEval eval_;
+  /** Optional, a vectorized evaluator for VARCHAR -> VARCHAR functions. */
+  BatchFunctionEval batch_eval_{nullptr};
+  /** If set, a NULL argument makes the result NULL without calling the evaluator. */
+  bool strict_{true};
+  /** Set if the result only depends on the arguments, which lets the planner fold calls on constants. */
+  bool deterministic_{true};
+  /**
+   * Optional, an evaluator for functions returning VARCHAR that writes the result string into an arena, for batch
+   * evaluation (see BatchExpression). The returned value does not own its string.
+   */
+  ArenaFunctionEval arena_eval_{nullptr};
+  /** If set, the last argument type repeats, so calls pass arg_types_.size() or more arguments. */
+  bool variadic_{false};
+
+  /** @return the type of argument `i`. Variadic functions take the last type for all the arguments past the end. */
+  auto ArgType(size_t i) const -> TypeId { return arg_types_[std::min(i, arg_types_.size() - 1)]; }
+};
+
+/**
+ * FunctionRegistry holds the scalar functions the planner can call, keyed by name and argument types.
+ *
+ * The built-in functions are registered when the registry is first used. More functions are added with Register(),
+ * before the queries using them are planned, and need no change in the planner. Resolving a call is a single hash probe
+ * of its name and argument types. Only when that misses are the overloads of the name consulted, to explain why.
+ */
+class FunctionRegistry {
+ public:
+  /** @return the registry of the process */
+  static auto Instance() -> FunctionRegistry &;
+
+  /**
+   * @brief Add a function. Registered functions are never removed, so pointers to them stay valid.
+   * @throws Exception if an overload with the same name and argument types is already registered
+   */
+  void Register(ScalarFunction function);
+
+  /** @return the overload of `name` taking exactly `arg_types`, nullptr if there is none */
+  auto Lookup(const std::string &name, const std::vector<TypeId> &arg_types) const -> const ScalarFunction *;
+
+  /**
+   * @brief Resolve a call for the planner.
+   *
+   * The overload taking exactly `arg_types` is found with a single hash probe. Failing that, the call resolves to the
+   * overload its arguments convert to most cheaply: a variadic overload, or one whose integer arguments are wider
+   * (TINYINT < SMALLINT < INTEGER < BIGINT), each widening step costing one. The caller casts the arguments, see
+   * ScalarFunctionExpression.
+   *
+   * @return the best overload of `name` for `arg_types`
+   * @throws Exception naming the unknown function, or the argument count or type that does not match
+   */
+  auto Resolve(const std::string &name, const std::vector<TypeId> &arg_types) const -> const ScalarFunction &;
+
+ private:
+  FunctionRegistry();
+
+  struct FunctionKey {
+    std::string name_;
+    std::vector<TypeId> arg_types_;
+
+    auto operator==(const FunctionKey &other) const -> bool {
+      return name_ == other.name_ && arg_types_ == other.arg_types_;
+    }
+  };
+
+  struct FunctionKeyHash {
+    auto operator()(const FunctionKey &key) const -> size_t;
+  };
+
+  /** Protects the maps. Registration takes it exclusively, lookups shared. */
+  mutable std::shared_mutex latch_;
+  std::unordered_map<FunctionKey, std::unique_ptr<ScalarFunction>, FunctionKeyHash> functions_;
+  /** The overloads of each name, for error messages. */
+  std::unordered_map<std::string, std::vector<const ScalarFunction *>> overloads_;
+};
+
+/** @brief Register upper, lower, length, substring, concat, trim, replace, starts_with and position. */
+void RegisterStringFunctions(FunctionRegistry *registry);
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+
+namespace bustub {
+
+/**
+ * Checkpoint is the state saved by a fuzzy checkpoint, from which recovery can start instead of the beginning of the
+ * log.
+ */
+struct Checkpoint {
+  /** The log tail when the checkpoint started. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  /** The dirty page table, i.e. (page id, recLSN) pairs. */
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+  /** The active transactions, i.e. (transaction id, LSN of its last record) pairs. */
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+
+  /** @return the LSN redo has to start at: the oldest recLSN, or the begin LSN if no page was dirty */
+  auto GetRedoLSN() const -> lsn_t;
+};
+
+/**
+ * CheckpointManager takes fuzzy checkpoints: it records the dirty page table and the active transactions without
+ * stopping transactions or flushing the buffer pool. Recovery then only has to redo from the oldest recLSN in the
+ * checkpoint, and only has to undo the transactions listed in it plus those that started later.
+ *
+ * The checkpoint is written to its own file, replacing the previous one atomically. A background thread can take a
+ * checkpoint periodically after writing back the pages with the oldest recLSNs, which keeps the redo start point and
+ * thereby the recovery time bounded.
+ */
+class CheckpointManager {
+ public:
+  /** Returns the active transactions as (transaction id, LSN of its last record) pairs. */
+  using ActiveTxnsCallback = std::function<std::vector<std::pair<txn_id_t, lsn_t>>()>;
+
+  /**
+   * @brief Creates a new CheckpointManager.
+   * @param bpm the buffer pool whose dirty page table is saved
+   * @param log_manager the log manager, nullptr if logging is disabled
+   * @param checkpoint_file the file the checkpoint is written to
+   * @param active_txns returns the active transactions, nullptr if there are none to track
+   */
+  CheckpointManager(BufferPoolManager *bpm, LogManager *log_manager, std::string checkpoint_file,
+                    ActiveTxnsCallback active_txns = nullptr);
+
+  ~CheckpointManager();
+
+  /**
+   * @brief Take a fuzzy checkpoint. The log is made durable up to the begin LSN before the checkpoint is written, so
+   * every LSN in it refers to a durable record.
+   * @return the checkpoint that was written
+   */
+  auto TakeCheckpoint() -> Checkpoint;
+
+  /**
+   * @brief Read the last checkpoint.
+   * @param checkpoint_file the checkpoint file
+   * @param[out] checkpoint the checkpoint
+   * @return false if there is no checkpoint
+   */
+  static auto LoadCheckpoint(const std::string &checkpoint_file, Checkpoint *checkpoint) -> bool;
+
+  /**
+   * @brief Start taking checkpoints in the background.
+   * @param interval the time between two checkpoints
+   * @param pages_per_round how many of the oldest dirty pages to write back before each checkpoint
+   */
+  void RunCheckpointThread(std::chrono::milliseconds interval, size_t pages_per_round);
+
+  /** @brief Stop the background checkpoints. */
+  void StopCheckpointThread();
+
+ private:
+  BufferPoolManager *bpm_;
+  LogManager *log_manager_;
+  std::string checkpoint_file_;
+  ActiveTxnsCallback active_txns_;
+
+  /** Serializes checkpoints. */
+  std::mutex checkpoint_latch_;
+
+  /** Protects running_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool running_{false};
+  std::thread checkpoint_thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,193 @@
+/**
+ * log_manager.h
+ *
+ * log manager maintain a separate thread that is awaken whenever the
+ * log buffer is full or whenever a timeout happens.
+ * When the thread is awaken, the log buffer's content is written into the disk log file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+#include "recovery/log_record.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * LogManagerStats summarizes the log throughput since the log manager was created.
+ */
+struct LogManagerStats {
+  /** Number of log records appended. */
+  size_t appends_{0};
+  /** Number of writes of the log buffer to the log file, i.e. DiskManager::WriteLog() calls. */
+  size_t log_writes_{0};
+  /** Number of log bytes written. */
+  size_t bytes_written_{0};
+  double appends_per_sec_{0};
+  double log_writes_per_sec_{0};
+};
+
+/**
+ * LogManager maintains the write-ahead log with group commit.
+ *
+ * The log tail is double-buffered. Appending a record reserves space in the active half with a single fetch-and-add on
+ * a word that packs the next LSN, the active half and the offset within it, so appenders never take a lock and LSN
+ * order always matches log order. When a reservation does not fit, the half is sealed and appenders move on to the
+ * other half once it has been written out. The flush thread seals the active half whenever someone waits for
+ * durability (or every log_timeout), writes it with one log write, and advances the persistent LSN. Committers wait for
+ * the persistent LSN to pass their commit record (see Flush()), so all commits that arrive during one log write share
+ * the next one.
+ *
+ * Without the flush thread, i.e. when logging is disabled, callers that need a flush perform it themselves.
+ */
+class LogManager {
+ public:
+  explicit LogManager(DiskManager *disk_manager)
+      : persistent_lsn_(INVALID_LSN), start_time_(std::chrono::steady_clock::now()), disk_manager_(disk_manager) {
+    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    halves_[0].data_ = log_buffer_;
+    halves_[1].data_ = flush_buffer_;
+  }
+
+  ~LogManager() {
+    StopFlushThread();
+    delete[] log_buffer_;
+    delete[] flush_buffer_;
+    log_buffer_ = nullptr;
+    flush_buffer_ = nullptr;
+  }
+
+  /** Start the flush thread and enable logging. */
+  void RunFlushThread();
+
+  /** Stop the flush thread, disable logging and write out what is left in the log buffer. */
+  void StopFlushThread();
+
+  /**
+   * Append a log record to the log buffer. Only blocks if both halves of the buffer are full.
+   * @param log_record the record to append, its LSN is assigned here
+   * @return the LSN of the record
+   */
+  auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
+
+  /**
+   * Block until the log is durable up to (and including) `lsn`, e.g. to commit a transaction or before writing back a
+   * page. Callers wait for the persistent LSN watermark instead of writing the log themselves, so concurrent callers
+   * share a single log write. LSNs that were never appended are treated as the latest appended one.
+   *
+   * @param lsn the LSN that has to be durable
+   */
+  void Flush(lsn_t lsn);
+
+  inline auto GetNextLSN() -> lsn_t { return LsnOf(tail_.load()); }
+  inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
+  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+
+  /**
+   * Continue the LSNs of an existing log, e.g. after recovery with LogRecovery::GetMaxLSN() + 1. The next record gets
+   * `next_lsn`, and everything before it counts as durable, since it was read back from the log file. Without this,
+   * new records would get LSNs below the page LSNs that were just redone, and the next recovery would skip them.
+   *
+   * Must be called before logging resumes: before the flush thread is started and before any record is appended.
+   *
+   * @param next_lsn the LSN of the next record
+   */
+  void SetNextLSN(lsn_t next_lsn);
+  inline auto GetLogBuffer() -> char * { return log_buffer_; }
+
+  /** @return the throughput statistics */
+  auto GetStats() -> LogManagerStats;
+
+ private:
+  /*
+   * Layout of tail_: | next LSN (31 bits) | active half (1 bit) | offset in the active half (32 bits) |
+   * An offset beyond LOG_BUFFER_SIZE means the active half is sealed and appenders wait for the switch.
+   */
+  static constexpr int HALF_SHIFT = 32;
+  static constexpr int LSN_SHIFT = 33;
+  static constexpr uint64_t OFFSET_MASK = (uint64_t{1} << HALF_SHIFT) - 1;
+  static constexpr uint64_t LSN_MASK = ~((uint64_t{1} << LSN_SHIFT) - 1);
+
+  static auto LsnOf(uint64_t tail) -> lsn_t { return static_cast<lsn_t>(tail >> LSN_SHIFT); }
+  static auto HalfOf(uint64_t tail) -> size_t { return (tail >> HALF_SHIFT) & 1; }
+  static auto OffsetOf(uint64_t tail) -> size_t { return tail & OFFSET_MASK; }
+
+  /** One half of the log buffer. */
+  struct LogHalf {
+    char *data_;
+    /** Bytes copied in by appenders, the half can be written once this reaches seal_size_. */
+    std::atomic<size_t> filled_{0};
+    /** The fields below are protected by latch_. */
+    bool sealed_{false};
+    size_t seal_size_{0};
+    /** The highest LSN that may be in this half. */
+    lsn_t end_lsn_{INVALID_LSN};
+  };
+
+  /**
+   * Seal half `half` at `size` bytes, wait until the other half is written out and make it the active half.
+   * Caller should hold the latch, and should have marked the active half as sealed in tail_.
+   * @param may_flush true if the caller may write out the other half itself
+   */
+  void SealAndSwitch(std::unique_lock<std::mutex> &lock, size_t half, size_t size, lsn_t next_lsn, bool may_flush);
+
+  /**
+   * Seal the active half if it has any records. Caller should hold the latch, and must not wait for the other half.
+   * @return true if progress was made
+   */
+  auto SealActiveHalf(std::unique_lock<std::mutex> &lock) -> bool;
+
+  /**
+   * Write out the sealed halves in log order. The latch is released during the writes.
+   * Caller should hold the latch and make sure no other flush is in progress.
+   * @return true if anything was written
+   */
+  auto FlushSealedHalves(std::unique_lock<std::mutex> &lock) -> bool;
+
+  /** Body of the flush thread. */
+  void FlushThreadLoop();
+
+  /** @brief Serialize a log record, whose LSN is already assigned, to `pos`. */
+  static void SerializeLogRecord(LogRecord *log_record, char *pos);
+
+  /** Reservation word, see the layout above. Kept apart from the rest so appenders only contend on this line. */
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  alignas(64) std::atomic<lsn_t> persistent_lsn_;
+  char *log_buffer_;
+  char *flush_buffer_;
+  LogHalf halves_[2];
+  /** The half that is written out next. */
+  size_t next_flush_half_{0};
+  /**
+   * LSNs that never name a record appended here: those of reservations that did not fit and were retried, and those
+   * skipped by SetNextLSN().
+   */
+  size_t lost_lsns_{0};
+  /** True while a flush is writing to disk. */
+  bool flushing_{false};
+  /** True if someone waits for the flush thread to flush. */
+  bool flush_requested_{false};
+  /** True while the flush thread runs. */
+  bool running_{false};
+  size_t num_flushes_{0};
+  size_t bytes_written_{0};
+  std::chrono::steady_clock::time_point start_time_;
+  /** Protects the flags and counters above and the slow path of appending. */
+  std::mutex latch_;
+  std::thread flush_thread_;
+  /** Wakes up the flush thread. */
+  std::condition_variable cv_;
+  /** Wakes up callers waiting for a flush or a half switch. */
+  std::condition_variable flushed_cv_;
+  DiskManager *disk_manager_;
+};
+
+}  // namespace bustub
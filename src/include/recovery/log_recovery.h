@@ -0,0 +1,146 @@
+/**
+ * log_recovery.h
+ *
+ * Read log file from disk, redo and undo.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "recovery/log_record.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * LogRecovery reads the log and redoes it after a crash.
+ *
+ * Redo runs in parallel. The log is read sequentially and every record that changes a page is handed to the worker
+ * owning that page (page id modulo the number of workers), so the records of one page are applied by one worker in
+ * LSN order, while different pages are redone concurrently. A record is skipped if the page LSN shows that the page
+ * already contains it. A prefetch thread fetches the pages referenced by queued records before the workers get to
+ * them, so page reads overlap with applying records.
+ *
+ * How a record is applied to a page depends on the page layout, so it is left to the caller (see RedoFunction).
+ */
+class LogRecovery {
+ public:
+  /** Applies a log record to the page it changes. Called with the page write latched. */
+  using RedoFunction = std::function<void(LogRecord *log_record, Page *page)>;
+
+  /**
+   * @brief Creates a new LogRecovery.
+   * @param disk_manager the disk manager to read the log from
+   * @param buffer_pool_manager the buffer pool to redo into, should have at least two frames per worker
+   * @param redo_function applies a record to a page
+   * @param num_workers the number of redo workers
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, RedoFunction redo_function,
+              size_t num_workers = std::max(1U, std::thread::hardware_concurrency()));
+
+  ~LogRecovery() { delete[] log_buffer_; }
+
+  DISALLOW_COPY_AND_MOVE(LogRecovery);
+
+  /**
+   * @brief Redo the log from `start_lsn`, e.g. the redo LSN of the last checkpoint. Returns once every record has
+   * been applied, rethrowing the first exception thrown by a worker.
+   *
+   * Also rebuilds the table of transactions that were active at the end of the log, and finds the highest LSN in the
+   * log (see GetMaxLSN()).
+   *
+   * @param start_lsn the first LSN to redo
+   */
+  void Redo(lsn_t start_lsn = 0);
+
+  /** @return the active transactions and the LSN of their last record, as of the end of the log */
+  auto GetActiveTxns() -> const std::unordered_map<txn_id_t, lsn_t> & { return active_txn_; }
+
+  /**
+   * @return the highest LSN in the log, INVALID_LSN if it is empty. Pass it plus one to LogManager::SetNextLSN()
+   * before logging resumes.
+   */
+  auto GetMaxLSN() -> lsn_t { return max_lsn_; }
+
+  /** @return the number of records applied by the last Redo() */
+  auto GetNumRedone() -> size_t { return num_redone_; }
+
+  /** @return the number of records the last Redo() skipped because their page was already up to date */
+  auto GetNumSkipped() -> size_t { return num_skipped_; }
+
+  /**
+   * @brief Deserialize a log record, the counterpart of LogManager::AppendLogRecord().
+   * @param data the serialized record
+   * @param size the number of bytes available at `data`
+   * @param[out] log_record the record
+   * @return false if there is no complete record at `data`
+   */
+  static auto DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool;
+
+ private:
+  /** Maximum number of records queued for one worker, bounds how far reading the log runs ahead. */
+  static constexpr size_t MAX_QUEUED_RECORDS = 1024;
+
+  /** A redo worker and the records queued for it. */
+  struct RedoWorker {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<LogRecord> records_;
+    bool done_{false};
+    std::thread thread_;
+  };
+
+  /** @return the page changed by a log record, or INVALID_PAGE_ID if it does not change a page */
+  static auto GetPageId(LogRecord *log_record) -> page_id_t;
+
+  void RunWorker(RedoWorker *worker);
+  void RunPrefetcher();
+
+  /** Hand a record to the worker owning its page. */
+  void Dispatch(LogRecord &&log_record, page_id_t page_id);
+
+  /** Remember the first exception thrown by a redo thread. */
+  void SetError(std::exception_ptr error);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  RedoFunction redo_function_;
+  std::vector<std::unique_ptr<RedoWorker>> workers_;
+
+  /** Pages to prefetch, at most prefetch_depth_ of them. Protected by prefetch_latch_. */
+  std::deque<page_id_t> prefetch_queue_;
+  size_t prefetch_depth_;
+  bool prefetch_done_{false};
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+
+  std::mutex error_latch_;
+  std::exception_ptr error_;
+  std::atomic<size_t> num_redone_{0};
+  std::atomic<size_t> num_skipped_{0};
+
+  /** Maintain active transactions and its corresponding latest lsn. */
+  std::unordered_map<txn_id_t, lsn_t> active_txn_;
+  /** Mapping the log sequence number to log file offset for undos. */
+  std::unordered_map<lsn_t, int> lsn_mapping_;
+
+  /** The highest LSN read by the last Redo(). */
+  lsn_t max_lsn_{INVALID_LSN};
+  int offset_{0};
+  char *log_buffer_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * CompressedDiskManager stores pages compressed on disk. It sits between the BufferPoolManager and the database file
+ * as a drop-in DiskManager; frames in the buffer pool always hold uncompressed pages.
+ *
+ * Compressed pages have variable sizes, so the file is carved into slots of whole SLOT_UNITs and a page mapping table
+ * records which slot holds each page. Freed slots are reused by pages of the same size class. Pages that do not
+ * compress below BUSTUB_PAGE_SIZE are stored as-is. The database file is only readable through this class.
+ *
+ * The mapping table is kept in memory and logged to a side file (`<db file>.map`). A page is never overwritten in
+ * place: WritePage() puts the new image into a free slot, then the new mapping is appended to the side file once the
+ * slot is durable, and the old slot is only freed once the mapping is durable. A crash therefore leaves every page at
+ * either its old or its new image. The side file is compacted when it is opened, and whenever it holds more than twice
+ * as many records as there are pages.
+ *
+ * The mappings are group-committed: concurrent writers compress and write their slots in parallel and queue their
+ * mappings, and the first of them to find no commit running syncs the database file, appends every queued mapping and
+ * syncs the side file on behalf of all of them. Each WritePage() returns once its mapping is durable. Writes of the
+ * same page must not overlap, which the BufferPoolManager guarantees.
+ */
+class CompressedDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new compressed disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   */
+  explicit CompressedDiskManager(const std::string &db_file);
+
+  /** Compacts the page mapping table. */
+  ~CompressedDiskManager() override;
+
+  /**
+   * Compress a page and write it to its slot in the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file and decompress it.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** @return the number of uncompressed bytes handed to WritePage() */
+  auto GetLogicalBytesWritten() -> uint64_t;
+
+  /** @return the number of bytes actually written to the database file */
+  auto GetPhysicalBytesWritten() -> uint64_t;
+
+  /** @brief Rewrite the side file with just the current page mappings. */
+  void SaveMappingTable();
+
+ private:
+  /** Slots are allocated in multiples of this many bytes. */
+  static constexpr size_t SLOT_UNIT = 512;
+  static constexpr size_t NUM_SLOT_CLASSES = BUSTUB_PAGE_SIZE / SLOT_UNIT;
+
+  /** Where a page lives in the database file. */
+  struct PageLocation {
+    /** Byte offset of the slot. */
+    uint64_t offset_;
+    /** Number of bytes stored, BUSTUB_PAGE_SIZE if the page is stored uncompressed. */
+    uint32_t size_;
+    /** Slot size class, the slot is (slot_class_ + 1) * SLOT_UNIT bytes. */
+    uint32_t slot_class_;
+  };
+
+  /** A page mapping as logged to the side file. */
+  struct MappingRecord {
+    page_id_t page_id_;
+    /** CRC32C of the record with this field zeroed, to detect a record torn by a crash. */
+    uint32_t checksum_;
+    PageLocation location_;
+  };
+
+  /** Records a compaction leaves room for before the side file is compacted again. */
+  static constexpr size_t MIN_RECORDS_BEFORE_COMPACTION = 1024;
+
+  /** @brief Read the side file up to the first torn record, and rebuild the free slots from the gaps. */
+  void LoadMappingTable();
+
+  /**
+   * @brief Rewrite the side file with the current mappings and reopen it for appending. Caller should acquire the
+   * latch, with no group commit running.
+   */
+  void CompactMappingTable();
+
+  /** A mapping waiting for the next group commit. */
+  struct PendingMapping {
+    page_id_t page_id_;
+    PageLocation location_;
+  };
+
+  /**
+   * @brief Make the queued mappings durable and install them, freeing the slots they replace. The latch is released
+   * while syncing, with committing_ set so that no other commit or compaction runs meanwhile.
+   * @param lock the held latch
+   */
+  void CommitMappings(std::unique_lock<std::mutex> &lock);
+
+  /** @return a record of a mapping, with its checksum */
+  static auto MakeRecord(page_id_t page_id, const PageLocation &location) -> MappingRecord;
+
+  /** @brief Allocate a slot of the given class, reusing a freed one if possible. */
+  auto AllocateSlot(uint32_t slot_class) -> uint64_t;
+
+  /** Page mapping table. */
+  std::unordered_map<page_id_t, PageLocation> page_map_;
+  /** Offsets of freed slots, by size class. */
+  std::vector<std::vector<uint64_t>> free_slots_;
+  /** End of the used part of the database file. */
+  uint64_t file_end_{0};
+  uint64_t logical_bytes_written_{0};
+  uint64_t physical_bytes_written_{0};
+  std::string db_file_name_;
+  std::string map_file_name_;
+  /** Descriptor of the database file, to sync what the stream wrote. */
+  int db_fd_{-1};
+  /** Descriptor of the side file, open for appending. */
+  int map_fd_{-1};
+  /** Number of records in the side file. */
+  size_t num_map_records_{0};
+  /** Mappings whose slots are written, waiting for the next group commit. */
+  std::vector<PendingMapping> pending_mappings_;
+  /** Group commits are numbered; the next one commits the mappings queued so far. */
+  uint64_t next_commit_{1};
+  /** The last group commit that finished. */
+  uint64_t last_commit_{0};
+  /** The last group commit that failed, whose writers throw. */
+  uint64_t failed_commit_{0};
+  /** Whether a group commit is running, without the latch. */
+  bool committing_{false};
+  /** Notified when a group commit finishes. */
+  std::condition_variable commit_cv_;
+  /** Protects all of the above and the database file stream. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
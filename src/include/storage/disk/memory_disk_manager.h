@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MemoryDiskManager keeps the pages in memory instead of a database file, as a DiskManager stand-in for stress tests
+ * and benchmarks of the buffer pool.
+ *
+ * A latency can be injected into every page read and write to imitate a real device. The latency is spent outside of
+ * this class's latch, so I/Os issued concurrently overlap. Note that the BufferPoolManager does its page I/O while
+ * holding its pool latch, so behind a buffer pool the I/Os of different threads are serialized and the latency shows
+ * up as a longer hold of the pool latch. Pages that were never written read as zeroes. The log is not kept, use a
+ * file backed DiskManager for logging.
+ */
+class MemoryDiskManager : public DiskManager {
+ public:
+  MemoryDiskManager() = default;
+
+  /**
+   * Copy a page into memory.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Copy a page out of memory.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * @brief Set the latency of every subsequent page read and write.
+   * @param read_latency the time a page read takes
+   * @param write_latency the time a page write takes
+   */
+  void SetLatency(std::chrono::microseconds read_latency, std::chrono::microseconds write_latency);
+
+  /** @return the number of pages read */
+  auto GetNumReads() -> size_t { return num_reads_.load(); }
+
+ private:
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> pages_;
+  /** Protects pages_ and num_writes_. */
+  std::mutex latch_;
+  std::atomic<int64_t> read_latency_us_{0};
+  std::atomic<int64_t> write_latency_us_{0};
+  std::atomic<size_t> num_reads_{0};
+};
+
+}  // namespace bustub
@@ -1,56 +1,152 @@
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <new>
 
 #include "common/config.h"
-#include "common/rwlatch.h"
+#include "common/hybrid_latch.h"
 
 namespace bustub {
 
+/** Size of a CPU cache line, the unit of false sharing between cores. */
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The book-keeping of a frame is padded to exactly one cache line and the page data lives in a separate,
+ * cache-line-aligned allocation. Pinning, unpinning or latching one frame therefore never contends with another core
+ * working on a neighbouring frame of the buffer pool.
  */
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
+  friend class MmapPageProvider;
 
  public:
   /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
+  Page() : Page(BUSTUB_PAGE_SIZE) {}
+
+  /**
+   * Constructor for pages of a runtime size. Zeros out the page data.
+   * @param page_size the size of the page data in bytes, at least SIZE_PAGE_HEADER
+   */
+  explicit Page(size_t page_size) : page_size_(page_size) {
+    data_ = static_cast<char *>(::operator new[](page_size_, std::align_val_t{CACHE_LINE_SIZE}));
     ResetMemory();
   }
 
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      ::operator delete[](data_, std::align_val_t{CACHE_LINE_SIZE});
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
 
+  /** @return the size of the page data in bytes */
+  inline auto GetPageSize() -> size_t { return page_size_; }
+
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int {
+    int pin_word = pin_count_.load();
+    return pin_word == PIN_CLAIMED ? 0 : pin_word & ~PIN_EVICTABLE;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version becomes odd while the write latch is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Acquire the page write latch if it is free. @return true if the latch was acquired */
+  inline auto TryWLatch() -> bool {
+    if (!rwlatch_.TryWLock()) {
+      return false;
+    }
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Acquire the page write latch if it is free and the page is still at `version`, without waiting. A failed attempt
+   * does not bump the version, so it does not invalidate optimistic readers of the page.
+   * @return true if the latch was acquired
+   */
+  inline auto TryWLatchAtVersion(uint64_t version) -> bool {
+    if (!rwlatch_.TryWLock()) {
+      return false;
+    }
+    // Writers only bump the version while holding the latch, so the version is stable now.
+    if (version_.load(std::memory_order_relaxed) != version) {
+      rwlatch_.WUnlock();
+      return false;
+    }
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if no writer holds or waits for it. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Atomically turn the held write latch into a read latch. */
+  inline void DowngradeLatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.Downgrade();
+  }
+
+  /**
+   * Try to turn the held read latch into a write latch without releasing it in between.
+   * @return true if the write latch is now held, false if other readers are present and the read latch is still held
+   */
+  inline auto TryUpgradeLatch() -> bool {
+    if (!rwlatch_.TryUpgrade()) {
+      return false;
+    }
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @return the current page version. The version is bumped on every write latch acquisition and release, so an odd
+   * version means a writer is active.
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if no writer touched the page since `version` was read, i.e. everything read since is consistent */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -61,26 +157,61 @@ class Page {
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
 
+  /**
+   * The page id and LSN. Only page layouts that are logged, i.e. that use GetLSN() / SetLSN(), have to leave the
+   * header alone; the buffer pool itself never writes into the page data.
+   */
   static constexpr size_t SIZE_PAGE_HEADER = 8;
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
 
+  /** Flag in pin_count_: the replacer considers the frame evictable. */
+  static constexpr int PIN_EVICTABLE = 1 << 30;
+  /** Value of pin_count_ while the frame holds no page or is being evicted. It cannot be pinned then. */
+  static constexpr int PIN_CLAIMED = -1;
+
  private:
+  /**
+   * Constructor for a page whose data lives in memory owned by someone else, e.g. a memory mapped file. The data is
+   * neither zeroed nor freed.
+   */
+  Page(page_id_t page_id, char *data, size_t page_size)
+      : data_(data), page_size_(page_size), page_id_(page_id), owns_data_(false) {}
+
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, page_size_); }
 
   /** The actual data that is stored within a page. */
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
+  /** The size of the page data. */
+  size_t page_size_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
-  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  /**
+   * The pin count of this page, plus PIN_EVICTABLE if the replacer was told the frame is evictable, or PIN_CLAIMED.
+   * Frames can be pinned without the BPM latch unless claimed, so eviction claims a frame by swapping an unpinned,
+   * evictable pin count for PIN_CLAIMED.
+   */
+  std::atomic<int> pin_count_ = 0;
+  /**
+   * True if the page is dirty, i.e. it is different from its corresponding page on disk. Only set or cleared under the
+   * BPM latch, but read without it to skip taking the latch for pages that are already dirty.
+   */
+  std::atomic<bool> is_dirty_ = false;
+  /** False if data_ is borrowed rather than allocated by the page. */
+  bool owns_data_ = true;
   /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  HybridLatch rwlatch_;
+  /** The log tail when the page was pinned while unpinned, a lower bound for the LSN of any change made since. */
+  std::atomic<lsn_t> pin_lsn_ = INVALID_LSN;
+  /** Seqlock-style version counter for optimistic readers, see GetVersion(). */
+  std::atomic<uint64_t> version_{0};
+  /** Bumped whenever the frame is claimed for another page, invalidating references to the page it held. */
+  std::atomic<uint64_t> generation_{0};
 };
 
+static_assert(sizeof(Page) == CACHE_LINE_SIZE, "the book-keeping of a frame should fill exactly one cache line");
+
 }  // namespace bustub
@@ -1,16 +1,26 @@
 #pragma once
 
+#include <memory>
+#include <utility>
+
 #include "common/logger.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
 class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
 
 class BasicPageGuard {
  public:
   BasicPageGuard() = default;
 
+  /**
+   * @param bpm the buffer pool the page is pinned in, or nullptr if the page is not pinned (see MmapPageProvider), in
+   * which case dropping the guard only releases its latch
+   * @param page the guarded page
+   */
   BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
 
   BasicPageGuard(const BasicPageGuard &) = delete;
@@ -60,6 +70,9 @@ class BasicPageGuard {
    */
   ~BasicPageGuard();
 
+  /** @return true if the guard holds a page, false if it is empty (moved from, dropped or the fetch failed) */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
   auto PageId() -> page_id_t { return page_->GetPageId(); }
 
   auto GetData() -> const char * { return page_->GetData(); }
@@ -69,8 +82,11 @@ class BasicPageGuard {
     return reinterpret_cast<const T *>(GetData());
   }
 
+  /** @brief Get the page data for writing. The first call marks the page dirty in the buffer pool right away. */
   auto GetDataMut() -> char * {
-    is_dirty_ = true;
+    if (!is_dirty_) {
+      MarkDirty();
+    }
     return page_->GetData();
   }
 
@@ -79,9 +95,37 @@ class BasicPageGuard {
     return reinterpret_cast<T *>(GetDataMut());
   }
 
+  /**
+   * @brief Upgrade to a ReadPageGuard
+   *
+   * The read latch is acquired on the page this guard holds, and the pin moves
+   * to the returned guard, which leaves this guard empty.
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
+  /**
+   * @brief Upgrade to a WritePageGuard
+   *
+   * Same as UpgradeRead(), but with the write latch.
+   */
+  auto UpgradeWrite() -> WritePageGuard;
+
+  /**
+   * @brief Non-blocking variants of UpgradeRead() / UpgradeWrite()
+   *
+   * If the latch cannot be acquired right away, an empty guard is returned and
+   * this guard keeps its pin.
+   */
+  auto TryUpgradeRead() -> ReadPageGuard;
+  auto TryUpgradeWrite() -> WritePageGuard;
+
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class OptimisticPageGuard;
+
+  /** Enter the page into the dirty page table, so a checkpoint taken while it is still pinned sees the change. */
+  void MarkDirty();
 
   BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
@@ -134,6 +178,8 @@ class ReadPageGuard {
    */
   ~ReadPageGuard();
 
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
   auto PageId() -> page_id_t { return guard_.PageId(); }
 
   auto GetData() -> const char * { return guard_.GetData(); }
@@ -143,7 +189,19 @@ class ReadPageGuard {
     return guard_.As<T>();
   }
 
+  /**
+   * @brief Try to upgrade to a WritePageGuard without releasing the latch or the pin
+   *
+   * This only succeeds if this guard is the sole reader of the page, in which case
+   * it becomes empty. Otherwise an empty WritePageGuard is returned and this guard
+   * keeps its read latch.
+   */
+  auto TryUpgradeWrite() -> WritePageGuard;
+
  private:
+  friend class BasicPageGuard;
+  friend class WritePageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
@@ -194,6 +252,8 @@ class WritePageGuard {
    */
   ~WritePageGuard();
 
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
   auto PageId() -> page_id_t { return guard_.PageId(); }
 
   auto GetData() -> const char * { return guard_.GetData(); }
@@ -210,9 +270,111 @@ class WritePageGuard {
     return guard_.AsMut<T>();
   }
 
+  /**
+   * @brief Downgrade to a ReadPageGuard
+   *
+   * The write latch turns into a read latch without letting another writer in,
+   * and the pin (and dirty flag) move to the returned guard, which leaves this
+   * guard empty.
+   */
+  auto Downgrade() -> ReadPageGuard;
+
  private:
+  friend class BasicPageGuard;
+  friend class ReadPageGuard;
+  friend class OptimisticPageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticPageGuard gives read access to a pinned page without taking its latch, so readers never write to the
+ * latch's cache line. The guard remembers the page version when it is created; anything read through it is only
+ * consistent if Validate() succeeds afterwards. On a failed validation the caller should Restart() and read again.
+ *
+ * Only modifications made under the page write latch (i.e. through a WritePageGuard) are detected.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+  OptimisticPageGuard(BufferPoolManager *bpm, Page *page);
+  OptimisticPageGuard(const OptimisticPageGuard &) = delete;
+  auto operator=(const OptimisticPageGuard &) -> OptimisticPageGuard & = delete;
+
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept;
+
+  auto operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard &;
+
+  /** @brief Unpin the page. An optimistic guard holds no latch. */
+  void Drop();
+
+  ~OptimisticPageGuard();
+
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return true if no writer latched the page since the guard was created or last restarted, false if empty */
+  auto Validate() -> bool { return guard_.page_ != nullptr && guard_.page_->ValidateVersion(version_); }
+
+  /** @brief Wait until no writer holds the page and take a new version snapshot. */
+  void Restart();
+
+  /**
+   * @brief Upgrade to a WritePageGuard, keeping the pin.
+   *
+   * Succeeds only if no writer latched the page since the version snapshot and the write latch is free, so whatever
+   * was read optimistically is still what the write guard sees. It never waits for the latch, and a failed upgrade
+   * leaves the page version alone, so it does not invalidate other optimistic readers. On success this guard becomes
+   * empty. On failure an empty WritePageGuard is returned and this guard is left as is, so the caller can Restart().
+   *
+   * @return the write guard, or an empty guard on conflict
+   */
+  auto TryUpgradeWrite() -> WritePageGuard;
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_{0};
+};
+
+/**
+ * PageSnapshot is an immutable image of a page as of the moment it was taken, see
+ * BufferPoolManager::FetchPageSnapshot(). It holds neither a pin nor a latch, so it can be kept for as long as needed,
+ * e.g. for a long scan, without blocking writers. Snapshots of the same page version share one reference-counted copy,
+ * which is freed with the last snapshot referring to it.
+ */
+class PageSnapshot {
+ public:
+  PageSnapshot() = default;
+  PageSnapshot(page_id_t page_id, uint64_t version, std::shared_ptr<const char[]> data)
+      : page_id_(page_id), version_(version), data_(std::move(data)) {}
+
+  auto IsValid() const -> bool { return data_ != nullptr; }
+
+  auto PageId() const -> page_id_t { return page_id_; }
+
+  /** @return the page version the snapshot was taken at, see Page::GetVersion() */
+  auto GetVersion() const -> uint64_t { return version_; }
+
+  auto GetData() const -> const char * { return data_.get(); }
+
+  template <class T>
+  auto As() const -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint64_t version_{0};
+  std::shared_ptr<const char[]> data_;
+};
+
 }  // namespace bustub
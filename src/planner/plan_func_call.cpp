@@ -16,7 +16,8 @@
 #include "execution/expressions/abstract_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/constant_value_expression.h"
-#include "execution/expressions/string_expression.h"
+#include "execution/expressions/scalar_function_expression.h"
+#include "execution/function_registry.h"
 #include "execution/plans/abstract_plan.h"
 #include "fmt/format.h"
 #include "planner/planner.h"
@@ -36,25 +37,34 @@ auto Planner::PlanFuncCall(const BoundFuncCall &expr, const std::vector<Abstract
 // NOLINTNEXTLINE
 auto Planner::GetFuncCallFromFactory(const std::string &func_name, std::vector<AbstractExpressionRef> args)
     -> AbstractExpressionRef {
-  // 1. check if the parsed function name is "lower" or "upper".
-  // 2. verify the number of args (should be 1), refer to the test cases for when you should throw an `Excepetion`.
-  // 3. return a `StringExpression` std::shared_ptr.
-
-  StringExpressionType st;
-  if (func_name == "upper") {
-    st = StringExpressionType::Upper;
-  } else if (func_name == "lower") {
-    st = StringExpressionType::Lower;
-  } else {
-    throw Exception(fmt::format("func call {} not supported in planner yet", func_name));
+  std::vector<TypeId> arg_types;
+  arg_types.reserve(args.size());
+  for (const auto &arg : args) {
+    arg_types.push_back(arg->GetReturnType());
+  }
+  const ScalarFunction &function = FunctionRegistry::Instance().Resolve(func_name, arg_types);
+  auto call = std::make_shared<ScalarFunctionExpression>(&function, std::move(args));
+  if (!function.deterministic_) {
+    return call;
   }
-  if (args.size() != 1) {
-    throw Exception(fmt::format("arg number should be 1, got {}", args.size()));
+
+  // Fold a call on constants into its result, so it is not recomputed for every row. The arguments were planned
+  // first, so nested calls on constants have already been folded into constants themselves.
+  std::vector<Value> arg_values;
+  arg_values.reserve(call->GetChildren().size());
+  for (const auto &arg : call->GetChildren()) {
+    const auto *constant = dynamic_cast<const ConstantValueExpression *>(arg.get());
+    if (constant == nullptr) {
+      return call;
+    }
+    arg_values.push_back(constant->val_);
   }
-  if (TypeId type = args[0]->GetReturnType(); type != TypeId::VARCHAR) {
-    throw Exception(fmt::format("expect the first arg to be varchar"));
+  try {
+    return std::make_shared<ConstantValueExpression>(call->Call(arg_values));
+  } catch (const Exception &) {
+    // Leave the error to execution, which only raises it if a row is actually evaluated.
+    return call;
   }
-  return std::make_shared<StringExpression>(args[0], st);
 }
 
 }  // namespace bustub
@@ -0,0 +1,129 @@
+#include "recovery/checkpoint_manager.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/file_util.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto Checkpoint::GetRedoLSN() const -> lsn_t {
+  lsn_t redo_lsn = begin_lsn_;
+  for (const auto &[_, rec_lsn] : dirty_pages_) {
+    if (rec_lsn != INVALID_LSN) {
+      redo_lsn = std::min(redo_lsn, rec_lsn);
+    }
+  }
+  return redo_lsn;
+}
+
+CheckpointManager::CheckpointManager(BufferPoolManager *bpm, LogManager *log_manager, std::string checkpoint_file,
+                                     ActiveTxnsCallback active_txns)
+    : bpm_(bpm),
+      log_manager_(log_manager),
+      checkpoint_file_(std::move(checkpoint_file)),
+      active_txns_(std::move(active_txns)) {}
+
+CheckpointManager::~CheckpointManager() { StopCheckpointThread(); }
+
+auto CheckpointManager::TakeCheckpoint() -> Checkpoint {
+  std::scoped_lock<std::mutex> lock(checkpoint_latch_);
+
+  // Everything below is fuzzy: transactions and the buffer pool keep running while the state is collected. Changes
+  // made after begin_lsn_ are covered by redoing from the checkpoint, whatever the snapshot says about them.
+  Checkpoint checkpoint;
+  if (log_manager_ != nullptr) {
+    checkpoint.begin_lsn_ = log_manager_->GetNextLSN();
+  }
+  if (active_txns_ != nullptr) {
+    checkpoint.active_txns_ = active_txns_();
+  }
+  for (const auto &[page_id, rec_lsn] : bpm_->GetDirtyPageTable()) {
+    checkpoint.dirty_pages_.emplace_back(page_id, rec_lsn);
+  }
+  if (enable_logging && log_manager_ != nullptr) {
+    log_manager_->Flush(checkpoint.begin_lsn_ - 1);
+  }
+
+  std::string data;
+  auto append = [&data](auto value) { data.append(reinterpret_cast<const char *>(&value), sizeof(value)); };
+  append(checkpoint.begin_lsn_);
+  append(static_cast<uint32_t>(checkpoint.dirty_pages_.size()));
+  for (const auto &[page_id, rec_lsn] : checkpoint.dirty_pages_) {
+    append(page_id);
+    append(rec_lsn);
+  }
+  append(static_cast<uint32_t>(checkpoint.active_txns_.size()));
+  for (const auto &[txn_id, last_lsn] : checkpoint.active_txns_) {
+    append(txn_id);
+    append(last_lsn);
+  }
+
+  // A crash leaves either checkpoint intact, and the new one survives a crash once this returns.
+  FileUtil::ReplaceFile(checkpoint_file_, data);
+  return checkpoint;
+}
+
+auto CheckpointManager::LoadCheckpoint(const std::string &checkpoint_file, Checkpoint *checkpoint) -> bool {
+  std::ifstream in(checkpoint_file, std::ios::binary);
+  uint32_t num_dirty_pages;
+  if (!in.read(reinterpret_cast<char *>(&checkpoint->begin_lsn_), sizeof(lsn_t)) ||
+      !in.read(reinterpret_cast<char *>(&num_dirty_pages), sizeof(uint32_t))) {
+    return false;
+  }
+  checkpoint->dirty_pages_.resize(num_dirty_pages);
+  for (auto &[page_id, rec_lsn] : checkpoint->dirty_pages_) {
+    in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id_t));
+    in.read(reinterpret_cast<char *>(&rec_lsn), sizeof(lsn_t));
+  }
+  uint32_t num_active_txns = 0;
+  in.read(reinterpret_cast<char *>(&num_active_txns), sizeof(uint32_t));
+  checkpoint->active_txns_.resize(num_active_txns);
+  for (auto &[txn_id, last_lsn] : checkpoint->active_txns_) {
+    in.read(reinterpret_cast<char *>(&txn_id), sizeof(txn_id_t));
+    in.read(reinterpret_cast<char *>(&last_lsn), sizeof(lsn_t));
+  }
+  if (!in) {
+    throw Exception(fmt::format("checkpoint {} is truncated", checkpoint_file));
+  }
+  return true;
+}
+
+void CheckpointManager::RunCheckpointThread(std::chrono::milliseconds interval, size_t pages_per_round) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  checkpoint_thread_ = std::thread([this, interval, pages_per_round] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval, [this] { return !running_; })) {
+      lock.unlock();
+      bpm_->FlushOldestDirtyPages(pages_per_round);
+      try {
+        TakeCheckpoint();
+      } catch (const Exception &e) {
+        // Keep the previous checkpoint, recovery just has to go back further.
+        LOG_WARN("checkpoint failed: %s", e.what());
+      }
+      lock.lock();
+    }
+  });
+}
+
+void CheckpointManager::StopCheckpointThread() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_one();
+  checkpoint_thread_.join();
+}
+
+}  // namespace bustub
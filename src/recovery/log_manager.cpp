@@ -0,0 +1,228 @@
+/**
+ * log_manager.cpp
+ */
+
+#include "recovery/log_manager.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void LogManager::RunFlushThread() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  enable_logging = true;
+  flush_thread_ = std::thread([this] { FlushThreadLoop(); });
+}
+
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    enable_logging = false;
+  }
+  cv_.notify_one();
+  flush_thread_.join();
+  Flush(GetNextLSN() - 1);
+}
+
+void LogManager::SetNextLSN(lsn_t next_lsn) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(!running_ && tail_.load() == 0, "the LSNs can only be set before logging starts");
+  tail_ = static_cast<uint64_t>(next_lsn) << LSN_SHIFT;
+  persistent_lsn_ = next_lsn - 1;
+  lost_lsns_ = static_cast<size_t>(next_lsn);
+}
+
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  auto size = static_cast<size_t>(log_record->size_);
+  BUSTUB_ASSERT(size <= LOG_BUFFER_SIZE, "log record does not fit into the log buffer");
+
+  while (true) {
+    uint64_t tail = tail_.fetch_add((uint64_t{1} << LSN_SHIFT) + size, std::memory_order_acq_rel);
+    size_t half = HalfOf(tail);
+    size_t offset = OffsetOf(tail);
+    if (offset + size <= LOG_BUFFER_SIZE) {
+      log_record->lsn_ = LsnOf(tail);
+      SerializeLogRecord(log_record, halves_[half].data_ + offset);
+      halves_[half].filled_.fetch_add(size, std::memory_order_release);
+      return log_record->lsn_;
+    }
+
+    // Slow path: the half is full. The first reservation past its end seals it, the others wait for the switch.
+    std::unique_lock<std::mutex> lock(latch_);
+    lost_lsns_++;
+    if (offset <= LOG_BUFFER_SIZE) {
+      SealAndSwitch(lock, half, offset, LsnOf(tail), !running_);
+    } else {
+      flushed_cv_.wait(lock, [this] { return OffsetOf(tail_.load()) <= LOG_BUFFER_SIZE; });
+    }
+  }
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min(lsn, GetNextLSN() - 1);
+  while (persistent_lsn_ < lsn) {
+    if (running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else if (flushing_) {
+      flushed_cv_.wait(lock);
+    } else {
+      bool progress = FlushSealedHalves(lock);
+      if (persistent_lsn_ < lsn && SealActiveHalf(lock)) {
+        FlushSealedHalves(lock);
+        progress = true;
+      }
+      if (!progress) {
+        // Another appender is switching halves.
+        flushed_cv_.wait(lock);
+      }
+    }
+  }
+}
+
+auto LogManager::GetStats() -> LogManagerStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  LogManagerStats stats;
+  stats.appends_ = static_cast<size_t>(GetNextLSN()) - lost_lsns_;
+  stats.log_writes_ = num_flushes_;
+  stats.bytes_written_ = bytes_written_;
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+  if (seconds > 0) {
+    stats.appends_per_sec_ = static_cast<double>(stats.appends_) / seconds;
+    stats.log_writes_per_sec_ = static_cast<double>(stats.log_writes_) / seconds;
+  }
+  return stats;
+}
+
+void LogManager::SealAndSwitch(std::unique_lock<std::mutex> &lock, size_t half, size_t size, lsn_t next_lsn,
+                               bool may_flush) {
+  halves_[half].sealed_ = true;
+  halves_[half].seal_size_ = size;
+  halves_[half].end_lsn_ = next_lsn - 1;
+  cv_.notify_one();
+
+  while (halves_[half ^ 1].sealed_) {
+    if (may_flush && !flushing_) {
+      FlushSealedHalves(lock);
+    } else {
+      flushed_cv_.wait(lock);
+    }
+  }
+
+  // Open the other half, keeping the LSNs handed out to the reservations that are waiting for it.
+  uint64_t tail = tail_.load();
+  while (!tail_.compare_exchange_weak(tail, (tail & LSN_MASK) | (uint64_t{half ^ 1} << HALF_SHIFT),
+                                      std::memory_order_acq_rel)) {
+  }
+  flushed_cv_.notify_all();
+}
+
+auto LogManager::SealActiveHalf(std::unique_lock<std::mutex> &lock) -> bool {
+  uint64_t tail = tail_.load();
+  while (true) {
+    size_t offset = OffsetOf(tail);
+    if (offset > LOG_BUFFER_SIZE) {
+      return false;
+    }
+    if (offset == 0) {
+      // Nothing reserved since the last switch: every LSN below the next one is durable or never named a record.
+      if (halves_[0].sealed_ || halves_[1].sealed_ || persistent_lsn_ >= LsnOf(tail) - 1) {
+        return false;
+      }
+      persistent_lsn_ = LsnOf(tail) - 1;
+      flushed_cv_.notify_all();
+      return true;
+    }
+    if (tail_.compare_exchange_weak(tail, (tail & ~OFFSET_MASK) | (LOG_BUFFER_SIZE + 1), std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+  // The other half was written out before, so this does not wait.
+  SealAndSwitch(lock, HalfOf(tail), OffsetOf(tail), LsnOf(tail), false);
+  return true;
+}
+
+auto LogManager::FlushSealedHalves(std::unique_lock<std::mutex> &lock) -> bool {
+  bool flushed = false;
+  while (halves_[next_flush_half_].sealed_) {
+    LogHalf &half = halves_[next_flush_half_];
+    size_t size = half.seal_size_;
+    flushing_ = true;
+    lock.unlock();
+    // Appenders that reserved space before the seal may still be copying their records.
+    while (half.filled_.load(std::memory_order_acquire) != size) {
+      std::this_thread::yield();
+    }
+    disk_manager_->WriteLog(half.data_, static_cast<int>(size));
+    lock.lock();
+    flushing_ = false;
+    num_flushes_++;
+    bytes_written_ += size;
+    half.filled_.store(0, std::memory_order_relaxed);
+    half.sealed_ = false;
+    persistent_lsn_ = std::max(persistent_lsn_.load(), half.end_lsn_);
+    next_flush_half_ ^= 1;
+    flushed = true;
+    flushed_cv_.notify_all();
+  }
+  return flushed;
+}
+
+void LogManager::FlushThreadLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (running_) {
+    cv_.wait_for(lock, log_timeout,
+                 [this] { return flush_requested_ || halves_[next_flush_half_].sealed_ || !running_; });
+    flush_requested_ = false;
+    // Group commit: everything appended while the previous batch was written goes out with the next one.
+    FlushSealedHalves(lock);
+    if (SealActiveHalf(lock)) {
+      FlushSealedHalves(lock);
+    }
+  }
+}
+
+void LogManager::SerializeLogRecord(LogRecord *log_record, char *pos) {
+  memcpy(pos, log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      log_record->insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      log_record->delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(pos);
+      pos += sizeof(uint32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      // BEGIN, COMMIT and ABORT records consist of the header only.
+      break;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,257 @@
+/**
+ * log_recovery.cpp
+ */
+
+#include "recovery/log_recovery.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+LogRecovery::LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager,
+                         RedoFunction redo_function, size_t num_workers)
+    : disk_manager_(disk_manager),
+      buffer_pool_manager_(buffer_pool_manager),
+      redo_function_(std::move(redo_function)),
+      workers_(num_workers),
+      prefetch_depth_(std::max<size_t>(1, buffer_pool_manager->GetPoolSize() / 2)) {
+  log_buffer_ = new char[LOG_BUFFER_SIZE];
+}
+
+auto LogRecovery::DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool {
+  // The header is the leading fields of LogRecord, copied as is by the log manager.
+  static_assert(sizeof(int32_t) + sizeof(lsn_t) + sizeof(txn_id_t) + sizeof(lsn_t) + sizeof(LogRecordType) ==
+                LogRecord::HEADER_SIZE);
+  if (size < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  int32_t record_size;
+  memcpy(&record_size, data, sizeof(int32_t));
+  if (record_size < LogRecord::HEADER_SIZE || static_cast<size_t>(record_size) > size) {
+    return false;
+  }
+
+  *log_record = LogRecord();
+  memcpy(static_cast<void *>(log_record), data, LogRecord::HEADER_SIZE);
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(uint32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::BEGIN:
+    case LogRecordType::COMMIT:
+    case LogRecordType::ABORT:
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+auto LogRecovery::GetPageId(LogRecord *log_record) -> page_id_t {
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      return log_record->GetInsertRID().GetPageId();
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record->GetDeleteRID().GetPageId();
+    case LogRecordType::UPDATE:
+      return log_record->GetUpdateRID().GetPageId();
+    case LogRecordType::NEWPAGE:
+      return log_record->page_id_;
+    default:
+      return INVALID_PAGE_ID;
+  }
+}
+
+void LogRecovery::Redo(lsn_t start_lsn) {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  offset_ = 0;
+  max_lsn_ = INVALID_LSN;
+  num_redone_ = 0;
+  num_skipped_ = 0;
+  error_ = nullptr;
+  prefetch_done_ = false;
+  for (auto &worker : workers_) {
+    worker = std::make_unique<RedoWorker>();
+    worker->thread_ = std::thread([this, w = worker.get()] { RunWorker(w); });
+  }
+  std::thread prefetcher([this] { RunPrefetcher(); });
+
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  try {
+    while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+      size_t pos = 0;
+      LogRecord log_record;
+      while (DeserializeLogRecord(log_buffer_ + pos, LOG_BUFFER_SIZE - pos, &log_record)) {
+        lsn_mapping_[log_record.GetLSN()] = offset_ + static_cast<int>(pos);
+        max_lsn_ = std::max(max_lsn_, log_record.GetLSN());
+        pos += log_record.GetSize();
+
+        switch (log_record.GetLogRecordType()) {
+          case LogRecordType::COMMIT:
+          case LogRecordType::ABORT:
+            active_txn_.erase(log_record.GetTxnId());
+            break;
+          default:
+            active_txn_[log_record.GetTxnId()] = log_record.GetLSN();
+            break;
+        }
+
+        page_id_t page_id = GetPageId(&log_record);
+        if (page_id == INVALID_PAGE_ID || log_record.GetLSN() < start_lsn) {
+          continue;
+        }
+        // Hint the prefetcher once per run of records on the same page; drop the hint if it is far enough ahead.
+        if (page_id != last_page_id) {
+          std::scoped_lock<std::mutex> lock(prefetch_latch_);
+          if (prefetch_queue_.size() < prefetch_depth_) {
+            prefetch_queue_.push_back(page_id);
+            prefetch_cv_.notify_one();
+          }
+          last_page_id = page_id;
+        }
+        Dispatch(std::move(log_record), page_id);
+      }
+      if (pos == 0) {
+        // No complete record left, this is the end of the log.
+        break;
+      }
+      offset_ += static_cast<int>(pos);
+    }
+  } catch (...) {
+    SetError(std::current_exception());
+  }
+
+  for (auto &worker : workers_) {
+    {
+      std::scoped_lock<std::mutex> lock(worker->latch_);
+      worker->done_ = true;
+    }
+    worker->cv_.notify_all();
+    worker->thread_.join();
+  }
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_latch_);
+    prefetch_done_ = true;
+  }
+  prefetch_cv_.notify_one();
+  prefetcher.join();
+
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void LogRecovery::Dispatch(LogRecord &&log_record, page_id_t page_id) {
+  RedoWorker &worker = *workers_[static_cast<size_t>(page_id) % workers_.size()];
+  std::unique_lock<std::mutex> lock(worker.latch_);
+  worker.cv_.wait(lock, [&] { return worker.records_.size() < MAX_QUEUED_RECORDS || worker.done_; });
+  worker.records_.push_back(std::move(log_record));
+  worker.cv_.notify_all();
+}
+
+void LogRecovery::RunWorker(RedoWorker *worker) {
+  std::deque<LogRecord> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(worker->latch_);
+      worker->cv_.wait(lock, [&] { return !worker->records_.empty() || worker->done_; });
+      if (worker->records_.empty()) {
+        return;
+      }
+      batch.swap(worker->records_);
+    }
+    worker->cv_.notify_all();
+
+    // Consecutive records of the same page are applied under one fetch and latch.
+    Page *page = nullptr;
+    bool is_dirty = false;
+    auto release = [&] {
+      if (page != nullptr) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+        page = nullptr;
+        is_dirty = false;
+      }
+    };
+    try {
+      for (auto &log_record : batch) {
+        page_id_t page_id = GetPageId(&log_record);
+        if (page == nullptr || page->GetPageId() != page_id) {
+          release();
+          page = buffer_pool_manager_->FetchPage(page_id);
+          if (page == nullptr) {
+            throw Exception(fmt::format("cannot fetch page {} for redo, the buffer pool is too small", page_id));
+          }
+          page->WLatch();
+        }
+        if (page->GetLSN() >= log_record.GetLSN()) {
+          num_skipped_++;
+          continue;
+        }
+        redo_function_(&log_record, page);
+        page->SetLSN(log_record.GetLSN());
+        is_dirty = true;
+        num_redone_++;
+      }
+      release();
+    } catch (...) {
+      release();
+      SetError(std::current_exception());
+      // Keep draining the queue so the reader never blocks on a full queue.
+    }
+    batch.clear();
+  }
+}
+
+void LogRecovery::RunPrefetcher() {
+  while (true) {
+    page_id_t page_id;
+    {
+      std::unique_lock<std::mutex> lock(prefetch_latch_);
+      prefetch_cv_.wait(lock, [this] { return !prefetch_queue_.empty() || prefetch_done_; });
+      if (prefetch_queue_.empty()) {
+        return;
+      }
+      page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+    }
+    if (buffer_pool_manager_->FetchPage(page_id) != nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+  }
+}
+
+void LogRecovery::SetError(std::exception_ptr error) {
+  std::scoped_lock<std::mutex> lock(error_latch_);
+  if (error_ == nullptr) {
+    error_ = std::move(error);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,241 @@
+#include "storage/disk/compressed_disk_manager.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/checksum_util.h"
+#include "common/util/compression_util.h"
+#include "common/util/file_util.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+CompressedDiskManager::CompressedDiskManager(const std::string &db_file)
+    : DiskManager(db_file), free_slots_(NUM_SLOT_CLASSES), db_file_name_(db_file), map_file_name_(db_file + ".map") {
+  db_fd_ = open(db_file.c_str(), O_RDWR);
+  if (db_fd_ < 0) {
+    throw Exception(fmt::format("cannot open db file {}: {}", db_file, strerror(errno)));
+  }
+  LoadMappingTable();
+  // Drop superseded and torn records, so that appends start at a record boundary.
+  SaveMappingTable();
+}
+
+CompressedDiskManager::~CompressedDiskManager() {
+  try {
+    SaveMappingTable();
+  } catch (const Exception &) {
+    // Every mapping is already durable in the side file, compaction only saves space.
+    LOG_DEBUG("I/O error while compacting the page mapping table");
+  }
+  close(map_fd_);
+  close(db_fd_);
+}
+
+void CompressedDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  // Only keep the compressed image if it saves at least one slot unit.
+  char buffer[CompressionUtil::MaxCompressedSize(BUSTUB_PAGE_SIZE)];
+  size_t size = CompressionUtil::Compress(page_data, BUSTUB_PAGE_SIZE, buffer, BUSTUB_PAGE_SIZE - SLOT_UNIT);
+  const char *data = buffer;
+  if (size == 0) {
+    size = BUSTUB_PAGE_SIZE;
+    data = page_data;
+  }
+  auto slot_class = static_cast<uint32_t>((size - 1) / SLOT_UNIT);
+
+  // Never overwrite the live image of a page: write a free slot, and switch the mapping over once the slot is durable.
+  std::unique_lock<std::mutex> lock(latch_);
+  PageLocation location{AllocateSlot(slot_class), static_cast<uint32_t>(size), slot_class};
+  lock.unlock();
+  try {
+    FileUtil::WriteAllAt(db_fd_, data, size, location.offset_, db_file_name_);
+  } catch (const Exception &) {
+    LOG_DEBUG("I/O error while writing");
+    lock.lock();
+    free_slots_[slot_class].push_back(location.offset_);
+    return;
+  }
+
+  lock.lock();
+  pending_mappings_.push_back({page_id, location});
+  uint64_t commit = next_commit_;
+  while (last_commit_ < commit) {
+    if (committing_) {
+      commit_cv_.wait(lock);
+    } else {
+      CommitMappings(lock);
+    }
+  }
+  if (failed_commit_ == commit) {
+    throw Exception(fmt::format("I/O error while committing page {}", page_id));
+  }
+}
+
+void CompressedDiskManager::CommitMappings(std::unique_lock<std::mutex> &lock) {
+  committing_ = true;
+  uint64_t commit = next_commit_++;
+  std::vector<PendingMapping> mappings;
+  mappings.swap(pending_mappings_);
+  lock.unlock();
+
+  // The slots have to be durable before the mappings that point to them.
+  std::string data;
+  data.reserve(mappings.size() * sizeof(MappingRecord));
+  for (const auto &mapping : mappings) {
+    MappingRecord record = MakeRecord(mapping.page_id_, mapping.location_);
+    data.append(reinterpret_cast<const char *>(&record), sizeof(record));
+  }
+  bool committed = true;
+  try {
+    FileUtil::Sync(db_fd_, db_file_name_);
+    FileUtil::WriteAll(map_fd_, data.data(), data.size(), map_file_name_);
+    FileUtil::Sync(map_fd_, map_file_name_);
+  } catch (const Exception &e) {
+    LOG_DEBUG("I/O error while committing page mappings: %s", e.what());
+    committed = false;
+  }
+
+  lock.lock();
+  for (const auto &mapping : mappings) {
+    const PageLocation &location = mapping.location_;
+    if (!committed) {
+      // The pages keep their old images. Some of the records may have reached the side file anyway, so the new slots
+      // stay unused; they are found free again when the side file is next loaded.
+      continue;
+    }
+    // The old slot is only reused once the mapping that replaces it is durable.
+    if (auto it = page_map_.find(mapping.page_id_); it != page_map_.end()) {
+      free_slots_[it->second.slot_class_].push_back(it->second.offset_);
+    }
+    page_map_[mapping.page_id_] = location;
+    num_writes_ += 1;
+    logical_bytes_written_ += BUSTUB_PAGE_SIZE;
+    physical_bytes_written_ += location.size_;
+  }
+  num_map_records_ += mappings.size();
+  if (!committed) {
+    failed_commit_ = commit;
+  }
+  last_commit_ = commit;
+  committing_ = false;
+  commit_cv_.notify_all();
+  if (committed && num_map_records_ > 2 * page_map_.size() + MIN_RECORDS_BEFORE_COMPACTION) {
+    CompactMappingTable();
+  }
+}
+
+void CompressedDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = page_map_.find(page_id);
+  if (it == page_map_.end()) {
+    // Never written, read it as an empty page like reading past the end of an uncompressed file.
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+
+  const PageLocation &location = it->second;
+  char buffer[BUSTUB_PAGE_SIZE];
+  char *target = location.size_ == BUSTUB_PAGE_SIZE ? page_data : buffer;
+  db_io_.seekg(static_cast<std::streamoff>(location.offset_));
+  db_io_.read(target, location.size_);
+  if (db_io_.bad() || db_io_.gcount() != location.size_) {
+    db_io_.clear();
+    throw Exception(fmt::format("I/O error while reading page {}", page_id));
+  }
+  if (target == buffer &&
+      CompressionUtil::Decompress(buffer, location.size_, page_data, BUSTUB_PAGE_SIZE) != BUSTUB_PAGE_SIZE) {
+    throw Exception(fmt::format("page {} cannot be decompressed", page_id));
+  }
+}
+
+auto CompressedDiskManager::GetLogicalBytesWritten() -> uint64_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return logical_bytes_written_;
+}
+
+auto CompressedDiskManager::GetPhysicalBytesWritten() -> uint64_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return physical_bytes_written_;
+}
+
+auto CompressedDiskManager::AllocateSlot(uint32_t slot_class) -> uint64_t {
+  auto &free_slots = free_slots_[slot_class];
+  if (!free_slots.empty()) {
+    uint64_t offset = free_slots.back();
+    free_slots.pop_back();
+    return offset;
+  }
+  uint64_t offset = file_end_;
+  file_end_ += (slot_class + 1) * SLOT_UNIT;
+  return offset;
+}
+
+void CompressedDiskManager::SaveMappingTable() {
+  std::unique_lock<std::mutex> lock(latch_);
+  commit_cv_.wait(lock, [this] { return !committing_; });
+  CompactMappingTable();
+}
+
+void CompressedDiskManager::CompactMappingTable() {
+  std::string data;
+  data.reserve(page_map_.size() * sizeof(MappingRecord));
+  for (const auto &[page_id, location] : page_map_) {
+    MappingRecord record = MakeRecord(page_id, location);
+    data.append(reinterpret_cast<const char *>(&record), sizeof(record));
+  }
+  if (map_fd_ >= 0) {
+    close(map_fd_);
+    map_fd_ = -1;
+  }
+  FileUtil::ReplaceFile(map_file_name_, data);
+  map_fd_ = open(map_file_name_.c_str(), O_WRONLY | O_APPEND);
+  if (map_fd_ < 0) {
+    throw Exception(fmt::format("cannot open {}: {}", map_file_name_, strerror(errno)));
+  }
+  num_map_records_ = page_map_.size();
+}
+
+auto CompressedDiskManager::MakeRecord(page_id_t page_id, const PageLocation &location) -> MappingRecord {
+  MappingRecord record{page_id, 0, location};
+  record.checksum_ = ChecksumUtil::Crc32c(reinterpret_cast<const char *>(&record), sizeof(record));
+  return record;
+}
+
+void CompressedDiskManager::LoadMappingTable() {
+  // Later records supersede earlier ones. A crash can only tear the last record, which is where reading stops.
+  std::ifstream in(map_file_name_, std::ios::binary);
+  MappingRecord record;
+  while (in.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+    if (MakeRecord(record.page_id_, record.location_).checksum_ != record.checksum_) {
+      break;
+    }
+    page_map_[record.page_id_] = record.location_;
+  }
+
+  // Every part of the file no page maps to is free, including the slots of superseded records.
+  std::vector<std::pair<uint64_t, uint64_t>> used;
+  used.reserve(page_map_.size());
+  for (const auto &[_, location] : page_map_) {
+    used.emplace_back(location.offset_, location.offset_ + (location.slot_class_ + 1) * SLOT_UNIT);
+  }
+  std::sort(used.begin(), used.end());
+  file_end_ = 0;
+  for (const auto &[begin, end] : used) {
+    for (uint64_t units = (begin - file_end_) / SLOT_UNIT; units > 0;) {
+      uint64_t slot_units = std::min<uint64_t>(units, NUM_SLOT_CLASSES);
+      free_slots_[slot_units - 1].push_back(file_end_);
+      file_end_ += slot_units * SLOT_UNIT;
+      units -= slot_units;
+    }
+    file_end_ = end;
+  }
+}
+
+}  // namespace bustub
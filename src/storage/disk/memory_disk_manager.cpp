@@ -0,0 +1,40 @@
+#include "storage/disk/memory_disk_manager.h"
+
+#include <cstring>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+void MemoryDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (auto latency = write_latency_us_.load(); latency > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(latency));
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &page = pages_[page_id];
+  if (page == nullptr) {
+    page = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+  }
+  memcpy(page.get(), page_data, BUSTUB_PAGE_SIZE);
+  num_writes_ += 1;
+}
+
+void MemoryDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (auto latency = read_latency_us_.load(); latency > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(latency));
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  num_reads_++;
+  auto it = pages_.find(page_id);
+  if (it == pages_.end()) {
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, it->second.get(), BUSTUB_PAGE_SIZE);
+}
+
+void MemoryDiskManager::SetLatency(std::chrono::microseconds read_latency, std::chrono::microseconds write_latency) {
+  read_latency_us_ = read_latency.count();
+  write_latency_us_ = write_latency.count();
+}
+
+}  // namespace bustub
@@ -1,4 +1,7 @@
 #include "storage/page/page_guard.h"
+
+#include <thread>  // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 
 namespace bustub {
@@ -12,7 +15,7 @@ BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept
 
 void BasicPageGuard::Drop() {
   if (bpm_ != nullptr && page_ != nullptr) {
-    bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+    bpm_->UnpinFrame(page_, is_dirty_);
   }
   bpm_ = nullptr;
   page_ = nullptr;
@@ -36,6 +39,47 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
 
 BasicPageGuard::~BasicPageGuard() { Drop(); }
 
+void BasicPageGuard::MarkDirty() {
+  is_dirty_ = true;
+  if (bpm_ != nullptr) {
+    bpm_->MarkFrameDirty(page_);
+  }
+}
+
+auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  if (page_ != nullptr) {
+    page_->RLatch();
+    read_guard.guard_ = std::move(*this);
+  }
+  return read_guard;
+}
+
+auto BasicPageGuard::UpgradeWrite() -> WritePageGuard {
+  WritePageGuard write_guard;
+  if (page_ != nullptr) {
+    page_->WLatch();
+    write_guard.guard_ = std::move(*this);
+  }
+  return write_guard;
+}
+
+auto BasicPageGuard::TryUpgradeRead() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  if (page_ != nullptr && page_->TryRLatch()) {
+    read_guard.guard_ = std::move(*this);
+  }
+  return read_guard;
+}
+
+auto BasicPageGuard::TryUpgradeWrite() -> WritePageGuard {
+  WritePageGuard write_guard;
+  if (page_ != nullptr && page_->TryWLatch()) {
+    write_guard.guard_ = std::move(*this);
+  }
+  return write_guard;
+}
+
 ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept : guard_(std::move(that.guard_)) {}
 
 auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
@@ -56,6 +100,14 @@ void ReadPageGuard::Drop() {
 
 ReadPageGuard::~ReadPageGuard() { Drop(); }
 
+auto ReadPageGuard::TryUpgradeWrite() -> WritePageGuard {
+  WritePageGuard write_guard;
+  if (guard_.page_ != nullptr && guard_.page_->TryUpgradeLatch()) {
+    write_guard.guard_ = std::move(guard_);
+  }
+  return write_guard;
+}
+
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept : guard_(std::move(that.guard_)) {}
 
 auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
@@ -80,4 +132,49 @@ void WritePageGuard::Drop() {
 
 WritePageGuard::~WritePageGuard() { Drop(); }
 
+auto WritePageGuard::Downgrade() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  if (guard_.page_ != nullptr) {
+    guard_.page_->DowngradeLatch();
+    read_guard.guard_ = std::move(guard_);
+  }
+  return read_guard;
+}
+
+OptimisticPageGuard::OptimisticPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+  if (guard_.page_ != nullptr) {
+    Restart();
+  }
+}
+
+OptimisticPageGuard::OptimisticPageGuard(OptimisticPageGuard &&that) noexcept
+    : guard_(std::move(that.guard_)), version_(that.version_) {}
+
+auto OptimisticPageGuard::operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard & {
+  if (this != &that) {
+    guard_ = std::move(that.guard_);
+    version_ = that.version_;
+  }
+  return *this;
+}
+
+void OptimisticPageGuard::Drop() { guard_.Drop(); }
+
+OptimisticPageGuard::~OptimisticPageGuard() { Drop(); }
+
+void OptimisticPageGuard::Restart() {
+  while (((version_ = guard_.page_->GetVersion()) & 1) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+auto OptimisticPageGuard::TryUpgradeWrite() -> WritePageGuard {
+  WritePageGuard write_guard;
+  if (guard_.page_ != nullptr && guard_.page_->ValidateVersion(version_) &&
+      guard_.page_->TryWLatchAtVersion(version_)) {
+    write_guard.guard_ = std::move(guard_);
+  }
+  return write_guard;
+}
+
 }  // namespace bustub